@@ -0,0 +1,98 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Множество номеров позиций в виде битовой карты; пересечение — побитовое И по словам
+class Bitmap {
+private:
+    std::vector<uint64_t> words;
+
+    static int lowestBit(uint64_t word) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+public:
+    void set(size_t pos) {
+        if (pos / 64 >= words.size()) {
+            words.resize(pos / 64 + 1, 0);
+        }
+        words[pos / 64] |= uint64_t(1) << (pos % 64);
+    }
+
+    void reset(size_t pos) {
+        if (pos / 64 < words.size()) {
+            words[pos / 64] &= ~(uint64_t(1) << (pos % 64));
+        }
+    }
+
+    bool test(size_t pos) const {
+        return pos / 64 < words.size() && (words[pos / 64] >> (pos % 64)) & 1;
+    }
+
+    Bitmap& operator&=(const Bitmap& other) {
+        if (words.size() > other.words.size()) {
+            words.resize(other.words.size());
+        }
+        for (size_t i = 0; i < words.size(); i++) {
+            words[i] &= other.words[i];
+        }
+        return *this;
+    }
+
+    // Первая установленная позиция в [pos, end) или end, если такой нет; целые слова пропускаются за шаг
+    size_t nextSet(size_t pos, size_t end) const {
+        while (pos < end && pos / 64 < words.size()) {
+            uint64_t word = words[pos / 64] >> (pos % 64);
+            if (word != 0) {
+                return std::min(end, pos + lowestBit(word));
+            }
+            pos = (pos / 64 + 1) * 64;
+        }
+        return end;
+    }
+
+    // Первая сброшенная позиция в [pos, end) или end, если такой нет
+    size_t nextClear(size_t pos, size_t end) const {
+        while (pos < end) {
+            if (pos / 64 >= words.size()) {
+                return pos;
+            }
+            uint64_t word = ~words[pos / 64] >> (pos % 64);
+            if (word != 0) {
+                return std::min(end, pos + lowestBit(word));
+            }
+            pos = (pos / 64 + 1) * 64;
+        }
+        return end;
+    }
+
+    bool empty() const {
+        return std::all_of(words.begin(), words.end(), [](uint64_t word) { return word == 0; });
+    }
+
+    // Вызывает visit(pos) для каждой установленной позиции по возрастанию
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (size_t i = 0; i < words.size(); i++) {
+            uint64_t word = words[i];
+            while (word != 0) {
+                visit(i * 64 + lowestBit(word));
+                word &= word - 1;
+            }
+        }
+    }
+};
+#endif
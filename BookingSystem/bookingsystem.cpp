@@ -1,24 +1,220 @@
 #include "bookingsystem.h"
+#include "recordreader.h"
+#include "clock.h"
 #include <fstream>
-#include <sstream>
-#include <numeric>
+#include <filesystem>
+#include <iterator>
+#include <cstdint>
+#include <limits>
 
-BookingSystem* BookingSystem::instance = nullptr;
+namespace {
+    const size_t PARSE_CHUNK_BYTES = 1 << 20;
+    const size_t BUILD_CHUNK_RECORDS = 1 << 16;
+
+    std::shared_ptr<User> parseUser(std::string_view line) {
+        RecordReader reader(line);
+        int id;
+        std::string name, email, phone;
+        if (!(reader.next(id) && reader.next(name) && reader.next(email) && reader.next(phone))) {
+            return nullptr;
+        }
+
+        return makePooled<User>(id, name, email, phone);
+    }
+
+    // Схема зала — необязательное последнее поле записи события
+    void parseSeatLayout(RecordReader& reader, Event& event) {
+        std::string layout;
+        if (reader.next(layout) && !layout.empty()) {
+            event.setSeatMap(SeatMap::parse(layout));
+        }
+    }
+
+    std::shared_ptr<Event> parseConcert(std::string_view line) {
+        RecordReader reader(line);
+        int id, totalSeats, availableSeats, duration;
+        double basePrice;
+        std::string name, date, venue, artist, genre, description, category;
+        if (!(reader.next(id) && reader.next(name) && reader.next(date) && reader.next(venue) &&
+            reader.next(totalSeats) && reader.next(availableSeats) && reader.next(basePrice) &&
+            reader.next(artist) && reader.next(genre) && reader.next(duration) &&
+            reader.next(description) && reader.next(category))) {
+            return nullptr;
+        }
+
+        auto concert = makePooled<Concert>(
+            id, name, date, venue, totalSeats, basePrice,
+            artist, genre, duration, description, category
+        );
+        concert->setAvailableSeats(availableSeats);
+        parseSeatLayout(reader, *concert);
+        return concert;
+    }
+
+    std::shared_ptr<Event> parseTheatrePlay(std::string_view line) {
+        RecordReader reader(line);
+        int id, totalSeats, availableSeats, duration, ageLimit;
+        double basePrice;
+        std::string name, date, venue, director, genre, description, category;
+        if (!(reader.next(id) && reader.next(name) && reader.next(date) && reader.next(venue) &&
+            reader.next(totalSeats) && reader.next(availableSeats) && reader.next(basePrice) &&
+            reader.next(director) && reader.next(genre) && reader.next(duration) && reader.next(ageLimit) &&
+            reader.next(description) && reader.next(category))) {
+            return nullptr;
+        }
+
+        auto play = makePooled<TheatrePlay>(
+            id, name, date, venue, totalSeats, basePrice,
+            director, genre, duration, ageLimit, description, category
+        );
+        play->setAvailableSeats(availableSeats);
+        parseSeatLayout(reader, *play);
+        return play;
+    }
+
+    std::shared_ptr<Ticket> parseTicket(std::string_view line) {
+        RecordReader reader(line);
+        int id, eventId, userId;
+        double price;
+        std::string_view bookingTime;
+        std::string_view status;
+        if (!(reader.next(id) && reader.next(eventId) && reader.next(userId) && reader.next(price) &&
+            reader.next(bookingTime) && reader.next(status))) {
+            return nullptr;
+        }
+
+        auto ticket = makePooled<Ticket>(id, eventId, userId, price, DateTime(bookingTime));
+        ticket->setIsActive(status == "active");
+        int seatId;
+        if (reader.next(seatId)) {
+            ticket->setSeatId(seatId);
+        }
+        std::string_view cancelTime;
+        if (reader.next(cancelTime)) {
+            ticket->setCancelDateTime(DateTime(cancelTime));
+        }
+        return ticket;
+    }
+
+    template <typename T>
+    using ParsedChunks = std::vector<std::future<std::vector<std::shared_ptr<T>>>>;
+
+    // Делит файл на части по границам строк и разбирает их в пуле потоков
+    template <typename T>
+    ParsedChunks<T> parseFileInParallel(ThreadPool& pool, const std::string& path,
+        std::shared_ptr<T>(*parse)(std::string_view)) {
+        ParsedChunks<T> chunks;
+        std::ifstream inFile(path, std::ios::binary);
+        if (!inFile.is_open()) {
+            return chunks;
+        }
+
+        auto content = std::make_shared<std::string>(
+            (std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+
+        size_t begin = 0;
+        while (begin < content->size()) {
+            size_t end = content->find('\n', std::min(begin + PARSE_CHUNK_BYTES, content->size()));
+            end = (end == std::string::npos) ? content->size() : end + 1;
+
+            chunks.push_back(pool.submit([content, begin, end, parse]() {
+                std::vector<std::shared_ptr<T>> parsed;
+                LineReader lines(std::string_view(*content).substr(begin, end - begin));
+                std::string_view line;
+                while (lines.next(line)) {
+                    if (auto item = parse(line)) {
+                        parsed.push_back(std::move(item));
+                    }
+                }
+                return parsed;
+            }));
+            begin = end;
+        }
+
+        return chunks;
+    }
+
+    template <typename T>
+    void collectChunks(ParsedChunks<T>& chunks, std::vector<std::shared_ptr<T>>& out) {
+        for (auto& chunk : chunks) {
+            auto parsed = chunk.get();
+            out.insert(out.end(), std::make_move_iterator(parsed.begin()), std::make_move_iterator(parsed.end()));
+        }
+    }
+
+    // Создает объекты из записей снимка диапазонами в пуле потоков
+    template <typename Record, typename T, typename Make>
+    void buildInParallel(ThreadPool& pool, const Record* records, size_t count,
+        std::vector<std::shared_ptr<T>>& out, std::vector<std::future<void>>& parts, Make make) {
+        out.resize(count);
+        for (size_t begin = 0; begin < count; begin += BUILD_CHUNK_RECORDS) {
+            size_t end = std::min(count, begin + BUILD_CHUNK_RECORDS);
+            parts.push_back(pool.submit([records, begin, end, &out, make]() {
+                for (size_t i = begin; i < end; i++) {
+                    out[i] = make(records[i]);
+                }
+            }));
+        }
+    }
+
+    // Состояние, снятое под блокировкой: события уже сериализованы (их немного),
+    // пользователи и билеты скопированы и сериализуются фоновым потоком
+    struct Snapshot {
+        std::vector<User> users;
+        std::vector<std::string> concerts;
+        std::vector<std::string> plays;
+        std::vector<std::string> events;
+        TicketTable tickets;
+        SnapshotWriter binary;
+    };
+
+    Ticket ticketFromRow(const TicketTable& table, size_t row) {
+        Ticket ticket(table.getIds()[row], table.getEventIds()[row], table.getUserIds()[row],
+            table.getPrices()[row], DateTime::fromSeconds(table.getBookingTimes()[row]));
+        ticket.setSeatId(table.getSeatIds()[row]);
+        if (!table.isActive(row)) {
+            ticket.setIsActive(false);
+            ticket.setCancelDateTime(DateTime::fromSeconds(table.getCancelTimes()[row]));
+        }
+        return ticket;
+    }
+}
+
+std::atomic<BookingSystem*> BookingSystem::instance{ nullptr };
+std::mutex BookingSystem::instanceMutex;
 
 BookingSystem::BookingSystem() : dataDirectory("./") {
     system(("mkdir " + dataDirectory + " 2>nul").c_str());
+    journal = std::make_unique<Journal>(dataDirectory + "journal.txt");
+    expiryThread = std::thread(&BookingSystem::expiryLoop, this);
+}
+
+BookingSystem::~BookingSystem() {
+    {
+        std::lock_guard<std::mutex> lock(expiryMutex);
+        stopping = true;
+    }
+    expiryCondition.notify_all();
+    expiryThread.join();
+    waitForCompaction();
 }
 
 BookingSystem& BookingSystem::getInstance() {
-    if (!instance) {
-        instance = new BookingSystem();
+    BookingSystem* current = instance.load(std::memory_order_acquire);
+    if (!current) {
+        std::lock_guard<std::mutex> lock(instanceMutex);
+        current = instance.load(std::memory_order_relaxed);
+        if (!current) {
+            current = new BookingSystem();
+            instance.store(current, std::memory_order_release);
+        }
     }
-    return *instance;
+    return *current;
 }
 
 void BookingSystem::destroy() {
-    delete instance;
-    instance = nullptr;
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    delete instance.exchange(nullptr);
 }
 
 std::shared_ptr<Concert> BookingSystem::createConcert(
@@ -26,12 +222,17 @@ std::shared_ptr<Concert> BookingSystem::createConcert(
     int totalSeats, double basePrice, const std::string& artist, const std::string& genre,
     int duration, const std::string& description, const std::string& category) {
 
-    auto concert = std::make_shared<Concert>(
+    auto concert = makePooled<Concert>(
         nextEventId++, name, date, venue, totalSeats, basePrice,
         artist, genre, duration, description, category
     );
-    events.push_back(concert);
-    concert->saveToFile();
+    {
+        std::unique_lock<std::shared_mutex> lock(dataMutex);
+        events.add(concert);
+        indexEvent(concert);
+        concert->saveToFile();
+    }
+    compactIfNeeded();
     return concert;
 }
 
@@ -40,147 +241,736 @@ std::shared_ptr<TheatrePlay> BookingSystem::createTheatrePlay(
     int totalSeats, double basePrice, const std::string& director, const std::string& genre,
     int duration, int ageLimit, const std::string& description, const std::string& category) {
 
-    auto play = std::make_shared<TheatrePlay>(
+    auto play = makePooled<TheatrePlay>(
         nextEventId++, name, date, venue, totalSeats, basePrice,
         director, genre, duration, ageLimit, description, category
     );
-    events.push_back(play);
-    play->saveToFile();
+    {
+        std::unique_lock<std::shared_mutex> lock(dataMutex);
+        events.add(play);
+        indexEvent(play);
+        play->saveToFile();
+    }
+    compactIfNeeded();
     return play;
 }
 
 std::shared_ptr<User> BookingSystem::createUser(
     const std::string& name, const std::string& email, const std::string& phone) {
 
-    auto user = std::make_shared<User>(nextUserId++, name, email, phone);
-    users.push_back(user);
-    user->saveToFile();
+    auto user = makePooled<User>(nextUserId++, name, email, phone);
+    {
+        std::unique_lock<std::shared_mutex> lock(dataMutex);
+        users.add(user);
+        userText.add(user->getId(), { user->getName() });
+        user->saveToFile();
+    }
+    compactIfNeeded();
     return user;
 }
 
 std::shared_ptr<Ticket> BookingSystem::createTicket(
     std::shared_ptr<Event> event, std::shared_ptr<User> user) {
 
-    if (event->getAvailableSeats() <= 0) {
+    if (!event->tryReserve()) {
         std::cout << "Ошибка: нет доступных мест для события " << event->getName() << std::endl;
         return nullptr;
     }
 
     double price = event->calculateTicketPrice();
-    auto ticket = std::make_shared<Ticket>(nextTicketId++, event->getId(), user->getId(), price);
-    tickets.push_back(ticket);
-    user->addTicket(ticket);
-    event->decreaseAvailableSeats();
-    ticket->saveToFile();
-
-    event->saveToFile();
+    auto ticket = makePooled<Ticket>(nextTicketId++, event->getId(), user->getId(), price);
+    std::future<void> durable;
+    {
+        std::unique_lock<std::shared_mutex> lock(dataMutex);
+        if (SeatMap* seats = event->getSeatMap()) {
+            for (int seat : seats->allocate(1)) {
+                ticket->setSeatId(seat);
+            }
+        }
+        registerTicket(ticket, *user);
+        durable = journal->appendDurable("Ticket", ticket->toRecord());
+    }
+    // Ждем сброса на диск вне блокировки, чтобы параллельные брони попали в одну группу
+    if (!waitDurable(durable)) {
+        rollbackTickets({ ticket });
+        return nullptr;
+    }
+    compactIfNeeded();
 
     return ticket;
 }
 
+std::vector<std::shared_ptr<Ticket>> BookingSystem::createTickets(
+    std::shared_ptr<Event> event, std::shared_ptr<User> user, int count) {
+
+    return checkoutCart({ CartItem{ event, count } }, user);
+}
+
+std::vector<std::shared_ptr<Ticket>> BookingSystem::checkoutCart(
+    const std::vector<CartItem>& items, std::shared_ptr<User> user) {
+
+    std::vector<std::shared_ptr<Ticket>> result;
+    if (!user) {
+        return result;
+    }
+    // Сумма по корзине не должна переполниться
+    int total = 0;
+    for (const auto& item : items) {
+        if (!item.event || item.count <= 0 || item.count > std::numeric_limits<int>::max() - total) {
+            std::cout << "Ошибка: неверное количество билетов в корзине" << std::endl;
+            return result;
+        }
+        total += item.count;
+    }
+
+    // Резервируем места по очереди; при нехватке возвращаем уже зарезервированные
+    for (size_t i = 0; i < items.size(); i++) {
+        if (!items[i].event->tryReserve(items[i].count)) {
+            for (size_t j = 0; j < i; j++) {
+                items[j].event->release(items[j].count);
+            }
+            std::cout << "Ошибка: недостаточно мест для события " << items[i].event->getName() << std::endl;
+            return result;
+        }
+    }
+
+    int nextId = nextTicketId.fetch_add(total);
+    result.reserve(total);
+    for (const auto& item : items) {
+        double price = item.event->calculateTicketPrice();
+        for (int i = 0; i < item.count; i++) {
+            result.push_back(makePooled<Ticket>(nextId++, item.event->getId(), user->getId(), price));
+        }
+    }
+
+    std::vector<std::string> records;
+    records.reserve(result.size());
+
+    std::future<void> durable;
+    {
+        std::unique_lock<std::shared_mutex> lock(dataMutex);
+        // Билеты одной позиции корзины получают соседние места, если они есть
+        size_t offset = 0;
+        for (const auto& item : items) {
+            if (SeatMap* seats = item.event->getSeatMap()) {
+                std::vector<int> assigned = seats->allocate(item.count);
+                for (size_t i = 0; i < assigned.size(); i++) {
+                    result[offset + i]->setSeatId(assigned[i]);
+                }
+            }
+            offset += item.count;
+        }
+
+        for (const auto& ticket : result) {
+            registerTicket(ticket, *user);
+            records.push_back(ticket->toRecord());
+        }
+        durable = journal->appendBatchDurable("Ticket", records);
+    }
+    if (!waitDurable(durable)) {
+        rollbackTickets(result);
+        return {};
+    }
+    compactIfNeeded();
+
+    return result;
+}
+
 bool BookingSystem::cancelTicket(int ticketId) {
-    auto ticketIt = std::find_if(tickets.begin(), tickets.end(),
-        [ticketId](const std::shared_ptr<Ticket>& t) {
-            return t->getId() == ticketId;
-        });
+    std::future<void> durable;
+    {
+        std::unique_lock<std::shared_mutex> lock(dataMutex);
+        auto ticket = tickets.find(ticketId);
+
+        if (!ticket || !ticket->getIsActive()) {
+            return false;
+        }
+        std::shared_ptr<Event> event;
+
+        DateTime now = Clock::now();
+        ticket->setIsActive(false);
+        ticket->setCancelDateTime(now);
+        ticketTable.setActive(tickets.slotOf(ticketId), false, now.toSeconds());
+        updateStats(ticket->getEventId(), ticket->getPrice(), &SalesStats::cancel);
+        updateRollups(ticket->getEventId(), now, ticket->getPrice(), true);
+
+        auto user = users.find(ticket->getUserId());
+        if (user) {
+            user->removeTicket(ticketId);
+        }
+
+        event = events.find(ticket->getEventId());
+        if (event) {
+            std::vector<int> seats;
+            if (ticket->getSeatId() != Ticket::NO_SEAT) {
+                seats.push_back(ticket->getSeatId());
+            }
+            returnSeats(event, 1, seats);
+        }
+        durable = journal->appendDurable("Ticket", ticket->toRecord());
+        waitPromotionWrites(lock);
+    }
+    // Отмена уже действует в памяти: при ошибке записи о ней сообщает waitDurable,
+    // а на диск она попадет со следующим снимком
+    if (waitDurable(durable)) {
+        compactIfNeeded();
+    }
+
+    return true;
+}
+
+std::shared_ptr<const SeatHold> BookingSystem::holdSeats(
+    std::shared_ptr<Event> event, std::shared_ptr<User> user, int count, int seconds) {
 
-    if (ticketIt == tickets.end() || !(*ticketIt)->getIsActive()) {
+    if (count <= 0 || seconds <= 0) {
+        return nullptr;
+    }
+    if (!event->tryReserve(count)) {
+        std::cout << "Ошибка: недостаточно мест для события " << event->getName() << std::endl;
+        return nullptr;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(dataMutex);
+    DateTime now = Clock::now();
+    expireHoldsLocked(now);
+    std::shared_ptr<const SeatHold> hold = createHold(*event, user->getId(), count, seconds, now);
+    waitPromotionWrites(lock);
+    return hold;
+}
+
+std::shared_ptr<SeatHold> BookingSystem::createHold(Event& event, int userId, int count, int seconds, const DateTime& now) {
+    auto hold = std::make_shared<SeatHold>();
+    hold->id = nextHoldId++;
+    hold->eventId = event.getId();
+    hold->userId = userId;
+    hold->count = count;
+    hold->price = event.calculateTicketPrice();
+    hold->expiresAt = now.addSeconds(seconds);
+    if (SeatMap* seats = event.getSeatMap()) {
+        hold->seats = seats->allocate(count);
+    }
+    holds.emplace(hold->id, hold);
+    holdExpiry.schedule(hold->id, hold->expiresAt.toSeconds(), now.toSeconds());
+    return hold;
+}
+
+std::vector<std::shared_ptr<Ticket>> BookingSystem::issueTickets(int eventId, User& user, int count, double price,
+    const std::vector<int>& seats, std::vector<std::string>& records) {
+
+    std::vector<std::shared_ptr<Ticket>> result;
+    result.reserve(count);
+    int nextId = nextTicketId.fetch_add(count);
+    for (int i = 0; i < count; i++) {
+        auto ticket = makePooled<Ticket>(nextId++, eventId, user.getId(), price);
+        if (static_cast<size_t>(i) < seats.size()) {
+            ticket->setSeatId(seats[i]);
+        }
+        registerTicket(ticket, user);
+        records.push_back(ticket->toRecord());
+        result.push_back(std::move(ticket));
+    }
+    return result;
+}
+
+std::vector<std::shared_ptr<Ticket>> BookingSystem::confirmHold(int holdId) {
+    std::vector<std::shared_ptr<Ticket>> result;
+    std::future<void> durable;
+    {
+        std::unique_lock<std::shared_mutex> lock(dataMutex);
+        // Удержание, срок которого уже прошел, подтвердить нельзя, даже если поток снятия не успел
+        expireHoldsLocked(Clock::now());
+        auto it = holds.find(holdId);
+        if (it == holds.end()) {
+            waitPromotionWrites(lock);
+            return result;
+        }
+
+        std::shared_ptr<SeatHold> hold = it->second;
+        holds.erase(it);
+        auto user = users.find(hold->userId);
+        if (!user) {
+            releaseHeldSeats(*hold);
+            waitPromotionWrites(lock);
+            return result;
+        }
+
+        // Места уже зарезервированы удержанием, поэтому билеты только оформляются
+        std::vector<std::string> records;
+        result = issueTickets(hold->eventId, *user, hold->count, hold->price, hold->seats, records);
+        durable = journal->appendBatchDurable("Ticket", records);
+        waitPromotionWrites(lock);
+    }
+    if (!waitDurable(durable)) {
+        rollbackTickets(result);
+        return {};
+    }
+    compactIfNeeded();
+
+    return result;
+}
+
+bool BookingSystem::releaseHold(int holdId) {
+    std::unique_lock<std::shared_mutex> lock(dataMutex);
+    auto it = holds.find(holdId);
+    if (it == holds.end()) {
         return false;
     }
 
-    (*ticketIt)->setIsActive(false);
+    // Таймер удержания остается в колесе и при срабатывании не найдет удержание
+    std::shared_ptr<SeatHold> hold = it->second;
+    holds.erase(it);
+    releaseHeldSeats(*hold);
+    waitPromotionWrites(lock);
+    return true;
+}
+
+size_t BookingSystem::expireHolds() {
+    {
+        std::shared_lock<std::shared_mutex> lock(dataMutex);
+        if (holds.empty()) {
+            return 0;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(dataMutex);
+    size_t expired = expireHoldsLocked(Clock::now());
+    waitPromotionWrites(lock);
+    return expired;
+}
 
-    auto eventIt = std::find_if(events.begin(), events.end(),
-        [&ticketIt](const std::shared_ptr<Event>& e) {
-            return e->getId() == (*ticketIt)->getEventId();
-        });
+size_t BookingSystem::getHoldCount() const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return holds.size();
+}
 
-    if (eventIt != events.end()) {
-        (*eventIt)->increaseAvailableSeats();
-        (*eventIt)->saveToFile();
+size_t BookingSystem::expireHoldsLocked(const DateTime& now) {
+    size_t expired = 0;
+    holdExpiry.advance(now.toSeconds(), [this, &expired](int holdId) {
+        auto it = holds.find(holdId);
+        if (it == holds.end()) {
+            return;
+        }
+        // Освободившиеся места могут сразу уйти в новое удержание из листа ожидания
+        std::shared_ptr<SeatHold> hold = it->second;
+        holds.erase(it);
+        releaseHeldSeats(*hold);
+        expired++;
+    });
+    return expired;
+}
+
+void BookingSystem::releaseHeldSeats(const SeatHold& hold) {
+    if (auto event = events.find(hold.eventId)) {
+        returnSeats(event, hold.count, hold.seats);
     }
+}
 
-    auto userIt = std::find_if(users.begin(), users.end(),
-        [&ticketIt](const std::shared_ptr<User>& u) {
-            return u->getId() == (*ticketIt)->getUserId();
-        });
+std::vector<std::shared_ptr<const SeatHold>> BookingSystem::getHoldsByUser(int userId) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    std::vector<std::shared_ptr<const SeatHold>> result;
+    for (const auto& hold : holds) {
+        if (hold.second->userId == userId) {
+            result.push_back(hold.second);
+        }
+    }
+    return result;
+}
+
+int BookingSystem::joinWaitlist(std::shared_ptr<Event> event, std::shared_ptr<User> user, int count,
+    WaitlistPromotion promotion, int priority) {
+
+    if (count <= 0 || count > event->getTotalSeats()) {
+        return 0;
+    }
 
-    if (userIt != users.end()) {
-        (*userIt)->removeTicket(ticketId);
+    int entryId = nextWaitlistId++;
+    {
+        std::unique_lock<std::shared_mutex> lock(dataMutex);
+        Waitlist& waitlist = waitlists[event->getId()];
+        waitlist.push(WaitlistEntry{ entryId, user->getId(), count, promotion }, priority);
+        // Если места уже есть, а очередь была пуста, заявка исполняется сразу
+        promoteWaiters(event, waitlist);
+        waitPromotionWrites(lock);
     }
+    compactIfNeeded();
+    return entryId;
+}
 
-    (*ticketIt)->saveToFile();
+bool BookingSystem::leaveWaitlist(int eventId, int entryId) {
+    std::unique_lock<std::shared_mutex> lock(dataMutex);
+    auto it = waitlists.find(eventId);
+    auto event = events.find(eventId);
+    if (it == waitlists.end() || !event || !it->second.remove(entryId)) {
+        return false;
+    }
 
+    // Придержанных мест может хватить следующей заявке, а без заявок они возвращаются в продажу
+    promoteWaiters(event, it->second);
+    waitPromotionWrites(lock);
     return true;
 }
 
+size_t BookingSystem::getWaitlistSize(int eventId) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    auto it = waitlists.find(eventId);
+    return (it != waitlists.end()) ? it->second.size() : 0;
+}
+
+void BookingSystem::returnSeats(const std::shared_ptr<Event>& event, int count, const std::vector<int>& seats) {
+    if (SeatMap* seatMap = event->getSeatMap()) {
+        for (int seat : seats) {
+            seatMap->release(seat);
+        }
+    }
+
+    auto it = waitlists.find(event->getId());
+    if (it == waitlists.end() || it->second.empty()) {
+        event->release(count);
+        return;
+    }
+
+    // Места не возвращаются в продажу, а передаются ожидающим
+    it->second.bank(count);
+    promoteWaiters(event, it->second);
+}
+
+void BookingSystem::promoteWaiters(const std::shared_ptr<Event>& event, Waitlist& waitlist) {
+    DateTime now = Clock::now();
+    while (const WaitlistEntry* entry = waitlist.front()) {
+        // Первой заявке не хватает придержанных мест — добираем из свободных, иначе ждем дальше
+        int missing = entry->count - waitlist.getBankedSeats();
+        if (missing > 0) {
+            if (!event->tryReserve(missing)) {
+                break;
+            }
+            waitlist.bank(missing);
+        }
+
+        WaitlistEntry promoted = *entry;
+        waitlist.pop();
+        auto user = users.find(promoted.userId);
+        if (!user) {
+            continue;
+        }
+
+        waitlist.unbank(promoted.count);
+        if (promoted.promotion == WaitlistPromotion::HOLD) {
+            createHold(*event, promoted.userId, promoted.count, WAITLIST_HOLD_SECONDS, now);
+        }
+        else {
+            std::vector<int> seats;
+            if (SeatMap* seatMap = event->getSeatMap()) {
+                seats = seatMap->allocate(promoted.count);
+            }
+            std::vector<std::string> records;
+            issueTickets(event->getId(), *user, promoted.count, event->calculateTicketPrice(), seats, records);
+            promotionWrites.push_back(journal->appendBatchDurable("Ticket", records));
+        }
+    }
+
+    if (waitlist.empty() && waitlist.getBankedSeats() > 0) {
+        event->release(waitlist.getBankedSeats());
+        waitlist.unbank(waitlist.getBankedSeats());
+    }
+}
+
+void BookingSystem::expiryLoop() {
+    std::unique_lock<std::mutex> lock(expiryMutex);
+    while (!expiryCondition.wait_for(lock, std::chrono::seconds(1), [this] { return stopping; })) {
+        lock.unlock();
+        expireHolds();
+        lock.lock();
+    }
+}
+
+void BookingSystem::updateEvent(const std::shared_ptr<Event>& event, const EventUpdate& update) {
+    {
+        std::unique_lock<std::shared_mutex> lock(dataMutex);
+        uint32_t oldCategory = event->getCategoryId();
+        unindexEvent(event);
+        if (update.name) {
+            event->setName(*update.name);
+        }
+        if (update.date) {
+            event->setDate(*update.date);
+        }
+        if (update.venue) {
+            event->setVenue(*update.venue);
+        }
+        if (update.basePrice) {
+            event->setBasePrice(*update.basePrice);
+        }
+        if (update.description) {
+            event->setDescription(*update.description);
+        }
+        if (update.category) {
+            event->setCategory(*update.category);
+        }
+        indexEvent(event);
+
+        // Продажи события переходят в итоги новой категории
+        uint32_t newCategory = event->getCategoryId();
+        auto stats = statsByEvent.find(event->getId());
+        if (newCategory != oldCategory && stats != statsByEvent.end()) {
+            statsByCategory[oldCategory] -= stats->second;
+            statsByCategory[newCategory] += stats->second;
+        }
+        auto rollup = rollupsByEvent.find(event->getId());
+        if (newCategory != oldCategory && rollup != rollupsByEvent.end()) {
+            rollupsByCategory[oldCategory].merge(rollup->second, -1);
+            rollupsByCategory[newCategory].merge(rollup->second);
+        }
+
+        event->saveToFile();
+    }
+    compactIfNeeded();
+}
+
+bool BookingSystem::setSeatLayout(const std::shared_ptr<Event>& event, const std::string& layout) {
+    std::unique_ptr<SeatMap> seatMap;
+    if (!layout.empty()) {
+        seatMap = SeatMap::parse(layout);
+        if (!seatMap) {
+            std::cout << "Ошибка: неверный формат схемы зала" << std::endl;
+            return false;
+        }
+        if (seatMap->getSeatCount() != event->getTotalSeats()) {
+            std::cout << "Ошибка: в схеме зала " << seatMap->getSeatCount() << " мест, а у события "
+                << event->getTotalSeats() << std::endl;
+            return false;
+        }
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(dataMutex);
+        if (event->getAvailableSeats() != event->getTotalSeats()) {
+            std::cout << "Ошибка: на событие " << event->getName() << " уже проданы билеты" << std::endl;
+            return false;
+        }
+
+        event->setSeatMap(std::move(seatMap));
+        event->saveToFile();
+    }
+    compactIfNeeded();
+    return true;
+}
+
+std::vector<int> BookingSystem::findBestAvailableSeats(const std::shared_ptr<Event>& event, int count) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    const SeatMap* seats = event->getSeatMap();
+    return seats ? seats->findBestAvailable(count) : std::vector<int>();
+}
+
+std::string BookingSystem::describeSeat(const Ticket& ticket) const {
+    auto event = events.find(ticket.getEventId());
+    if (!event || !event->getSeatMap() || ticket.getSeatId() == Ticket::NO_SEAT) {
+        return std::string();
+    }
+    return event->getSeatMap()->describe(ticket.getSeatId());
+}
+
+std::string BookingSystem::getSeatDescription(const Ticket& ticket) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return describeSeat(ticket);
+}
+
 std::shared_ptr<Event> BookingSystem::findEventById(int id) {
-    auto it = std::find_if(events.begin(), events.end(),
-        [id](const std::shared_ptr<Event>& e) {
-            return e->getId() == id;
-        });
-    return (it != events.end()) ? *it : nullptr;
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return events.find(id);
 }
 
 std::shared_ptr<User> BookingSystem::findUserById(int id) {
-    auto it = std::find_if(users.begin(), users.end(),
-        [id](const std::shared_ptr<User>& u) {
-            return u->getId() == id;
-        });
-    return (it != users.end()) ? *it : nullptr;
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return users.find(id);
 }
 
 std::shared_ptr<Ticket> BookingSystem::findTicketById(int id) {
-    auto it = std::find_if(tickets.begin(), tickets.end(),
-        [id](const std::shared_ptr<Ticket>& t) {
-            return t->getId() == id;
-        });
-    return (it != tickets.end()) ? *it : nullptr;
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return tickets.find(id);
+}
+
+std::string BookingSystem::describeTicket(int id) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    auto ticket = tickets.find(id);
+    return ticket ? ticket->toRecord() : std::string();
+}
+
+std::string BookingSystem::describeEvent(int id) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    auto event = events.find(id);
+    return event ? event->getRecordType() + "\t" + event->toRecord() : std::string();
 }
 
 std::vector<std::shared_ptr<Event>> BookingSystem::findEventsByName(const std::string& nameSubstr) {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
     std::vector<std::shared_ptr<Event>> result;
 
-    for (const auto& event : events) {
-        if (event->getName().find(nameSubstr) != std::string::npos) {
-            result.push_back(event);
-        }
+    for (int id : eventText.search(nameSubstr, 0)) {
+        result.push_back(events.find(id));
     }
 
     return result;
 }
 
-std::vector<std::shared_ptr<Event>> BookingSystem::findEventsByCategory(const std::string& category) {
+std::vector<std::shared_ptr<Event>> BookingSystem::findEventsByText(const std::string& text) {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
     std::vector<std::shared_ptr<Event>> result;
 
-    for (const auto& event : events) {
-        if (event->getCategory() == category) {
-            result.push_back(event);
+    for (int id : eventText.search(text)) {
+        result.push_back(events.find(id));
+    }
+
+    return result;
+}
+
+std::vector<std::shared_ptr<Event>> BookingSystem::suggestEvents(
+    const std::string& prefix, size_t limit, SuggestionOrder order) {
+
+    // Ключ сортировки снимается один раз: число свободных мест меняется без эксклюзивной блокировки
+    struct Candidate {
+        bool past;
+        int64_t key;
+        int id;
+    };
+
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    DateTime now = Clock::now();
+    std::vector<Candidate> candidates;
+    for (int id : eventPrefixes.find(prefix)) {
+        auto event = events.find(id);
+        if (order == SuggestionOrder::AVAILABLE_SEATS) {
+            candidates.push_back({ false, -static_cast<int64_t>(event->getAvailableSeats()), id });
+        }
+        else {
+            candidates.push_back({ event->getEventDate() <= now, event->getEventDate().toSeconds(), id });
         }
     }
 
+    // Сначала будущие события, затем меньший ключ: ближайшая дата или больше свободных мест
+    auto better = [](const Candidate& a, const Candidate& b) {
+        if (a.past != b.past) {
+            return b.past;
+        }
+        return a.key != b.key ? a.key < b.key : a.id < b.id;
+    };
+    size_t count = std::min(limit, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), better);
+
+    std::vector<std::shared_ptr<Event>> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        result.push_back(events.find(candidates[i].id));
+    }
     return result;
 }
 
-std::vector<std::shared_ptr<Event>> BookingSystem::findEventsByDate(const std::string& date) {
+std::vector<std::shared_ptr<Event>> BookingSystem::findEventsByCategory(const std::string& category) {
+    EventFilter filter;
+    filter.category = category;
+    return findEvents(filter);
+}
+
+std::vector<std::shared_ptr<Event>> BookingSystem::findEvents(const EventFilter& filter) {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
     std::vector<std::shared_ptr<Event>> result;
-    DateTime searchDate(date);
 
-    for (const auto& event : events) {
-        if (event->getEventDate().toDateString() == searchDate.toDateString()) {
-            result.push_back(event);
+    const std::pair<const std::string*, const std::unordered_map<uint32_t, Bitmap>*> conditions[] = {
+        { &filter.category, &eventsByCategory },
+        { &filter.genre, &eventsByGenre },
+        { &filter.venue, &eventsByVenue },
+    };
+
+    Bitmap matched;
+    bool restricted = false;
+    for (const auto& condition : conditions) {
+        if (condition.first->empty()) {
+            continue;
+        }
+
+        const StringPool::Entry* value = StringPool::find(*condition.first);
+        auto it = value ? condition.second->find(value->id) : condition.second->end();
+        if (it == condition.second->end()) {
+            return result;
+        }
+
+        if (restricted) {
+            matched &= it->second;
+        }
+        else {
+            matched = it->second;
+            restricted = true;
         }
     }
 
+    if (!restricted) {
+        return events.all();
+    }
+
+    matched.forEach([&](size_t slot) {
+        result.push_back(events.at(slot));
+    });
+
     return result;
 }
 
-std::vector<std::shared_ptr<Event>> BookingSystem::getUpcomingEvents() {
+BookingSystem::EventDateRange BookingSystem::findEventsByDate(const std::string& date) {
+    DateTime day(date);
+    if (!day.isValid()) {
+        return EventDateRange();
+    }
+
+    DateTime dayStart = DateTime::fromSeconds(day.getDay() * DateTime::SECONDS_PER_DAY);
+    return getEventsBetween(dayStart, dayStart.addSeconds(DateTime::SECONDS_PER_DAY));
+}
+
+BookingSystem::EventDateRange BookingSystem::getEventsBetween(const DateTime& from, const DateTime& to) {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return eventsByDate.between(from, to);
+}
+
+BookingSystem::EventDateRange BookingSystem::getUpcomingEvents() {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return eventsByDate.after(Clock::now());
+}
+
+BookingSystem::EventDateRange BookingSystem::getEventsSortedByDate(bool ascending) {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return eventsByDate.all(ascending);
+}
+
+const SortedIndex<double, Event>& BookingSystem::priceIndex(PriceKind kind) const {
+    return (kind == PriceKind::EFFECTIVE) ? eventsByEffectivePrice : eventsByBasePrice;
+}
+
+BookingSystem::EventPriceRange BookingSystem::getEventsSortedByPrice(bool ascending, PriceKind kind) {
+    return getTopEventsByPrice(SIZE_MAX, ascending, kind);
+}
+
+BookingSystem::EventPriceRange BookingSystem::getTopEventsByPrice(size_t count, bool ascending, PriceKind kind) {
+    if (kind == PriceKind::EFFECTIVE) {
+        refreshEffectivePrices();
+    }
+
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return priceIndex(kind).all(ascending).take(count);
+}
+
+std::vector<std::shared_ptr<Event>> BookingSystem::findTopEventsByPrice(
+    size_t count, const std::function<bool(const Event&)>& filter, bool ascending, PriceKind kind) {
+
+    if (kind == PriceKind::EFFECTIVE) {
+        refreshEffectivePrices();
+    }
+
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
     std::vector<std::shared_ptr<Event>> result;
-    DateTime now = DateTime::now();
 
-    for (const auto& event : events) {
-        if (event->getEventDate() > now) {
+    // Обход по возрастанию цены останавливается, как только набрано count событий
+    for (const auto& event : priceIndex(kind).all(ascending)) {
+        if (result.size() >= count) {
+            break;
+        }
+        if (filter(*event)) {
             result.push_back(event);
         }
     }
@@ -188,70 +978,270 @@ std::vector<std::shared_ptr<Event>> BookingSystem::getUpcomingEvents() {
     return result;
 }
 
-std::vector<std::shared_ptr<Event>> BookingSystem::getEventsSortedByDate(bool ascending) {
-    std::vector<std::shared_ptr<Event>> result = events;
+BookingSystem::EventPriceRange BookingSystem::getEventsInPriceRange(
+    double minPrice, double maxPrice, bool ascending, PriceKind kind) {
 
-    std::sort(result.begin(), result.end(),
-        [ascending](const std::shared_ptr<Event>& a, const std::shared_ptr<Event>& b) {
-            return ascending ?
-                (a->getEventDate() < b->getEventDate()) :
-                (a->getEventDate() > b->getEventDate());
-        });
+    if (kind == PriceKind::EFFECTIVE) {
+        refreshEffectivePrices();
+    }
 
-    return result;
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return priceIndex(kind).within(minPrice, maxPrice, ascending);
 }
 
-std::vector<std::shared_ptr<Event>> BookingSystem::getEventsSortedByPrice(bool ascending) {
-    std::vector<std::shared_ptr<Event>> result = events;
+BookingSystem::EventPriceRange BookingSystem::getEventsPageByPrice(size_t pageSize, bool ascending, PriceKind kind) {
+    return getTopEventsByPrice(pageSize, ascending, kind);
+}
 
-    std::sort(result.begin(), result.end(),
-        [ascending](const std::shared_ptr<Event>& a, const std::shared_ptr<Event>& b) {
-            return ascending ?
-                (a->getBasePrice() < b->getBasePrice()) :
-                (a->getBasePrice() > b->getBasePrice());
-        });
+BookingSystem::EventPriceRange BookingSystem::getEventsPageByPrice(
+    const EventPriceCursor& after, size_t pageSize, bool ascending, PriceKind kind) {
 
-    return result;
+    if (kind == PriceKind::EFFECTIVE) {
+        refreshEffectivePrices();
+    }
+
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return priceIndex(kind).page(after, pageSize, ascending);
 }
 
 std::vector<std::shared_ptr<User>> BookingSystem::findUsersByName(const std::string& nameSubstr) {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
     std::vector<std::shared_ptr<User>> result;
 
-    for (const auto& user : users) {
-        if (user->getName().find(nameSubstr) != std::string::npos) {
-            result.push_back(user);
-        }
+    for (int id : userText.search(nameSubstr)) {
+        result.push_back(users.find(id));
     }
 
     return result;
 }
 
-std::vector<std::shared_ptr<Ticket>> BookingSystem::getTicketsByUser(int userId) {
-    std::vector<std::shared_ptr<Ticket>> result;
+void BookingSystem::registerTicket(const std::shared_ptr<Ticket>& ticket, User& user) {
+    tickets.add(ticket);
+    ticketTable.append(*ticket);
+    indexTicket(ticket);
+    updateStats(ticket->getEventId(), ticket->getPrice(), &SalesStats::book);
+    updateRollups(ticket->getEventId(), ticket->getBookingDateTime(), ticket->getPrice(), false);
+    user.addTicket(ticket);
+}
 
-    for (const auto& ticket : tickets) {
-        if (ticket->getUserId() == userId) {
-            result.push_back(ticket);
+void BookingSystem::unregisterTicket(const std::shared_ptr<Ticket>& ticket) {
+    int eventId = ticket->getEventId();
+    size_t slot = tickets.remove(ticket->getId());
+    if (slot == Registry<Ticket>::NO_SLOT) {
+        return;
+    }
+    ticketTable.removeRow(slot);
+    unindexTicket(ticket);
+
+    if (!ticket->getIsActive()) {
+        // Билет успели отменить — снимаем и отмену; место уже возвращено ею
+        updateStats(eventId, ticket->getPrice(), &SalesStats::restore);
+        updateRollups(eventId, ticket->getCancelDateTime(), ticket->getPrice(), true, -1);
+    }
+    else if (auto event = events.find(eventId)) {
+        std::vector<int> seats;
+        if (ticket->getSeatId() != Ticket::NO_SEAT) {
+            seats.push_back(ticket->getSeatId());
         }
+        returnSeats(event, 1, seats);
     }
+    updateStats(eventId, ticket->getPrice(), &SalesStats::unbook);
+    updateRollups(eventId, ticket->getBookingDateTime(), ticket->getPrice(), false, -1);
 
-    return result;
+    if (auto user = users.find(ticket->getUserId())) {
+        user->removeTicket(ticket->getId());
+    }
 }
 
-std::vector<std::shared_ptr<Ticket>> BookingSystem::getTicketsByEvent(int eventId) {
-    std::vector<std::shared_ptr<Ticket>> result;
+void BookingSystem::indexTicket(const std::shared_ptr<Ticket>& ticket) {
+    ticketsByUser[ticket->getUserId()].push_back(ticket);
+    ticketsByEvent[ticket->getEventId()].push_back(ticket);
+}
 
-    for (const auto& ticket : tickets) {
-        if (ticket->getEventId() == eventId) {
-            result.push_back(ticket);
+void BookingSystem::unindexTicket(const std::shared_ptr<Ticket>& ticket) {
+    for (auto* byKey : { &ticketsByUser[ticket->getUserId()], &ticketsByEvent[ticket->getEventId()] }) {
+        // Откатываются только что выданные билеты, поэтому ищем с конца
+        auto it = std::find(byKey->rbegin(), byKey->rend(), ticket);
+        if (it != byKey->rend()) {
+            byKey->erase(std::next(it).base());
         }
     }
+}
 
-    return result;
+void BookingSystem::indexEvent(const std::shared_ptr<Event>& event) {
+    eventsByDate.insert(event->getEventDate(), event);
+    eventsByBasePrice.insert(event->getBasePrice(), event);
+    eventsByEffectivePrice.insert(event->calculateTicketPrice(), event);
+    eventText.add(event->getId(), event->getSearchFields());
+    eventPrefixes.add(event->getId(), event->getSearchFields());
+
+    size_t slot = events.slotOf(event->getId());
+    eventsByCategory[event->getCategoryId()].set(slot);
+    eventsByGenre[event->getGenreId()].set(slot);
+    eventsByVenue[event->getVenueId()].set(slot);
+}
+
+void BookingSystem::unindexEvent(const std::shared_ptr<Event>& event) {
+    eventsByDate.erase(event->getEventDate(), event->getId());
+    eventsByBasePrice.erase(event->getBasePrice(), event->getId());
+    eventsByEffectivePrice.erase(event->calculateTicketPrice(), event->getId());
+    eventText.remove(event->getId());
+    eventPrefixes.remove(event->getId());
+
+    size_t slot = events.slotOf(event->getId());
+    eventsByCategory[event->getCategoryId()].reset(slot);
+    eventsByGenre[event->getGenreId()].reset(slot);
+    eventsByVenue[event->getVenueId()].reset(slot);
+}
+
+void BookingSystem::rebuildIndexes() {
+    eventsByDate.rebuild(events, [](const Event& event) { return event.getEventDate(); });
+    eventsByBasePrice.rebuild(events, [](const Event& event) { return event.getBasePrice(); });
+    eventsByEffectivePrice.rebuild(events, [](const Event& event) { return event.calculateTicketPrice(); });
+    effectivePriceDay = Clock::now().getDay();
+
+    eventText.clear();
+    for (const auto& event : events) {
+        eventText.add(event->getId(), event->getSearchFields());
+    }
+
+    eventPrefixes.rebuild(events, [](const Event& event) { return event.getSearchFields(); });
+
+    eventsByCategory.clear();
+    eventsByGenre.clear();
+    eventsByVenue.clear();
+    for (size_t slot = 0; slot < events.size(); slot++) {
+        const auto& event = events.at(slot);
+        eventsByCategory[event->getCategoryId()].set(slot);
+        eventsByGenre[event->getGenreId()].set(slot);
+        eventsByVenue[event->getVenueId()].set(slot);
+    }
+
+    // При восстановлении из журнала категория события могла измениться после продаж
+    statsByCategory.clear();
+    for (const auto& stats : statsByEvent) {
+        auto event = events.find(stats.first);
+        if (event) {
+            statsByCategory[event->getCategoryId()] += stats.second;
+        }
+    }
+
+    userText.clear();
+    for (const auto& user : users) {
+        userText.add(user->getId(), { user->getName() });
+    }
+}
+
+void BookingSystem::updateStats(int eventId, double price, void (SalesStats::*change)(double)) {
+    (totalStats.*change)(price);
+    (statsByEvent[eventId].*change)(price);
+
+    auto event = events.find(eventId);
+    if (event) {
+        (statsByCategory[event->getCategoryId()].*change)(price);
+    }
+}
+
+void BookingSystem::updateRollups(int eventId, const DateTime& time, double price, bool canceled, int sign) {
+    void (SalesRollup::*record)(const DateTime&, double, int) =
+        canceled ? &SalesRollup::addCancellation : &SalesRollup::addBooking;
+
+    (totalRollup.*record)(time, price, sign);
+    (rollupsByEvent[eventId].*record)(time, price, sign);
+
+    auto event = events.find(eventId);
+    if (event) {
+        (rollupsByCategory[event->getCategoryId()].*record)(time, price, sign);
+    }
+}
+
+// Строится по колоночной таблице, не разбирая строки времени.
+// Отмены из старых записей без времени отмены относятся ко времени бронирования.
+void BookingSystem::rebuildRollups() {
+    totalRollup.clear();
+    rollupsByEvent.clear();
+    rollupsByCategory.clear();
+
+    const auto& eventIds = ticketTable.getEventIds();
+    const auto& prices = ticketTable.getPrices();
+    const auto& bookingTimes = ticketTable.getBookingTimes();
+    const auto& cancelTimes = ticketTable.getCancelTimes();
+    for (size_t row = 0; row < ticketTable.size(); row++) {
+        DateTime time = DateTime::fromSeconds(bookingTimes[row]);
+        SalesRollup& rollup = rollupsByEvent[eventIds[row]];
+        rollup.addBooking(time, prices[row]);
+        if (!ticketTable.isActive(row)) {
+            DateTime cancelTime = DateTime::fromSeconds(cancelTimes[row]);
+            rollup.addCancellation(cancelTime.isValid() ? cancelTime : time, prices[row]);
+        }
+    }
+
+    for (const auto& rollup : rollupsByEvent) {
+        totalRollup.merge(rollup.second);
+
+        auto event = events.find(rollup.first);
+        if (event) {
+            rollupsByCategory[event->getCategoryId()].merge(rollup.second);
+        }
+    }
+}
+
+// Итоговая цена концерта зависит от дня недели, поэтому индекс перестраивается при смене дня
+void BookingSystem::refreshEffectivePrices() {
+    int64_t today = Clock::now().getDay();
+    {
+        std::shared_lock<std::shared_mutex> lock(dataMutex);
+        if (effectivePriceDay == today) {
+            return;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(dataMutex);
+    if (effectivePriceDay != today) {
+        eventsByEffectivePrice.rebuild(events, [](const Event& event) { return event.calculateTicketPrice(); });
+        effectivePriceDay = today;
+    }
+}
+
+std::vector<std::shared_ptr<Ticket>> BookingSystem::getTicketsByUser(int userId) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    auto it = ticketsByUser.find(userId);
+    return (it != ticketsByUser.end()) ? it->second : std::vector<std::shared_ptr<Ticket>>();
+}
+
+std::vector<std::shared_ptr<Ticket>> BookingSystem::getTicketsByEvent(int eventId) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    auto it = ticketsByEvent.find(eventId);
+    return (it != ticketsByEvent.end()) ? it->second : std::vector<std::shared_ptr<Ticket>>();
+}
+
+void BookingSystem::forEachTicketOfUser(int userId, const TicketVisitor& visit) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    auto it = ticketsByUser.find(userId);
+    if (it == ticketsByUser.end()) {
+        return;
+    }
+    for (const auto& ticket : it->second) {
+        visit(*ticket, events.find(ticket->getEventId()).get());
+    }
+}
+
+void BookingSystem::forEachTicketOfEvent(int eventId, const TicketVisitor& visit) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    auto it = ticketsByEvent.find(eventId);
+    if (it == ticketsByEvent.end()) {
+        return;
+    }
+    const Event* event = events.find(eventId).get();
+    for (const auto& ticket : it->second) {
+        visit(*ticket, event);
+    }
 }
 
 std::vector<std::shared_ptr<Ticket>> BookingSystem::getActiveTickets() {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
     std::vector<std::shared_ptr<Ticket>> result;
+    result.reserve(totalStats.getActiveCount());
 
     for (const auto& ticket : tickets) {
         if (ticket->getIsActive()) {
@@ -264,6 +1254,7 @@ std::vector<std::shared_ptr<Ticket>> BookingSystem::getActiveTickets() {
 
 // Другие методы для работы с системой
 void BookingSystem::displayAllEvents() const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
     std::cout << "=================== Список событий ===================\n";
     for (const auto& event : events) {
         event->display();
@@ -272,6 +1263,7 @@ void BookingSystem::displayAllEvents() const {
 }
 
 void BookingSystem::displayAllUsers() const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
     std::cout << "=================== Список пользователей ===================\n";
     for (const auto& user : users) {
         user->display();
@@ -280,160 +1272,445 @@ void BookingSystem::displayAllUsers() const {
 }
 
 void BookingSystem::displayAllTickets() const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
     std::cout << "=================== Список билетов ===================\n";
     for (const auto& ticket : tickets) {
         ticket->display();
+        if (ticket->getSeatId() != Ticket::NO_SEAT) {
+            std::cout << "Место: " << describeSeat(*ticket) << "\n";
+        }
         std::cout << "----------------------------------------------------\n";
     }
 }
 
 double BookingSystem::getTotalSales() const {
-    return std::accumulate(tickets.begin(), tickets.end(), 0.0,
-        [](double sum, const std::shared_ptr<Ticket>& t) {
-            return sum + (t->getIsActive() ? t->getPrice() : 0);
-        });
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return totalStats.getTotalSales();
 }
 
 int BookingSystem::getActiveTicketsCount() const {
-    return std::count_if(tickets.begin(), tickets.end(),
-        [](const std::shared_ptr<Ticket>& t) {
-            return t->getIsActive();
-        });
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return totalStats.getActiveCount();
 }
 
 int BookingSystem::getCanceledTicketsCount() const {
-    return std::count_if(tickets.begin(), tickets.end(),
-        [](const std::shared_ptr<Ticket>& t) {
-            return !t->getIsActive();
-        });
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return totalStats.getCanceledCount();
 }
 
 double BookingSystem::getAverageTicketPrice() const {
-    if (tickets.empty()) {
-        return 0.0;
-    }
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return totalStats.getAverageTicketPrice();
+}
 
-    double totalPrice = std::accumulate(tickets.begin(), tickets.end(), 0.0,
-        [](double sum, const std::shared_ptr<Ticket>& t) {
-            return sum + t->getPrice();
-        });
+SalesStats BookingSystem::getSalesStats() const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return totalStats;
+}
+
+SalesStats BookingSystem::getEventSalesStats(int eventId) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    auto it = statsByEvent.find(eventId);
+    return (it != statsByEvent.end()) ? it->second : SalesStats();
+}
+
+SalesStats BookingSystem::getCategorySalesStats(const std::string& category) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    const StringPool::Entry* value = StringPool::find(category);
+    auto it = value ? statsByCategory.find(value->id) : statsByCategory.end();
+    return (it != statsByCategory.end()) ? it->second : SalesStats();
+}
+
+double BookingSystem::getSalesForEvent(int eventId) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return ticketTable.sumActivePricesForEvent(eventId);
+}
+
+double BookingSystem::getSalesInPriceRange(double minPrice, double maxPrice) const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return ticketTable.sumActivePricesInRange(minPrice, maxPrice);
+}
+
+std::vector<double> BookingSystem::getSalesByEvent() const {
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return ticketTable.sumActivePricesByEvent();
+}
+
+std::vector<RollupBucket> BookingSystem::getSalesHistory(
+    const DateTime& from, const DateTime& to, RollupPeriod period) const {
 
-    return totalPrice / tickets.size();
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    return totalRollup.query(from, to, period);
+}
+
+std::vector<RollupBucket> BookingSystem::getEventSalesHistory(int eventId,
+    const DateTime& from, const DateTime& to, RollupPeriod period) const {
+
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    auto it = rollupsByEvent.find(eventId);
+    return (it != rollupsByEvent.end()) ? it->second.query(from, to, period) : std::vector<RollupBucket>();
+}
+
+std::vector<RollupBucket> BookingSystem::getCategorySalesHistory(const std::string& category,
+    const DateTime& from, const DateTime& to, RollupPeriod period) const {
+
+    std::shared_lock<std::shared_mutex> lock(dataMutex);
+    const StringPool::Entry* value = StringPool::find(category);
+    auto it = value ? rollupsByCategory.find(value->id) : rollupsByCategory.end();
+    return (it != rollupsByCategory.end()) ? it->second.query(from, to, period) : std::vector<RollupBucket>();
 }
 
 void BookingSystem::setDataDirectory(const std::string& dir) {
+    waitForCompaction();
+    std::unique_lock<std::shared_mutex> lock(dataMutex);
     dataDirectory = dir;
     system(("mkdir " + dataDirectory + " 2>nul").c_str());
+    journal = std::make_unique<Journal>(dataDirectory + "journal.txt");
 }
 
-void BookingSystem::saveAllData() const {
-    for (const auto& event : events) {
-        event->saveToFile();
+bool BookingSystem::waitDurable(std::future<void>& durable) {
+    try {
+        durable.get();
+        return true;
     }
+    catch (const std::exception& e) {
+        std::cout << "Ошибка: " << e.what() << std::endl;
+        return false;
+    }
+}
 
-    for (const auto& user : users) {
-        user->saveToFile();
+// Ожидающий не ждет ответа, поэтому при сбое журнала выданные билеты остаются
+// и попадут на диск со следующим снимком
+void BookingSystem::waitPromotionWrites(std::unique_lock<std::shared_mutex>& lock) {
+    std::vector<std::future<void>> writes;
+    writes.swap(promotionWrites);
+    lock.unlock();
+    for (auto& write : writes) {
+        waitDurable(write);
     }
+}
 
-    for (const auto& ticket : tickets) {
-        ticket->saveToFile();
+void BookingSystem::rollbackTickets(const std::vector<std::shared_ptr<Ticket>>& issued) {
+    std::unique_lock<std::shared_mutex> lock(dataMutex);
+    for (const auto& ticket : issued) {
+        unregisterTicket(ticket);
     }
+    // Возвращенные места могли достаться листу ожидания
+    waitPromotionWrites(lock);
 }
 
-void BookingSystem::loadData() {
-    std::ifstream userFile(dataDirectory + "users.txt");
-    if (userFile.is_open()) {
-        int id;
-        std::string name, email, phone;
+void BookingSystem::compactIfNeeded() {
+    if (compacting || journal->getByteCount() < compactionThreshold) {
+        return;
+    }
 
-        std::string line;
-        while (std::getline(userFile, line)) {
-            std::istringstream iss(line);
-            if (iss >> id >> name >> email >> phone) {
-                nextUserId = std::max(nextUserId, id + 1);
+    // Если сжатие уже запускает другой поток или еще пишет снимок, повторно его не начинаем
+    std::unique_lock<std::mutex> lock(compactionMutex, std::try_to_lock);
+    if (lock.owns_lock() && !compacting && journal->getByteCount() >= compactionThreshold) {
+        startCompaction();
+    }
+}
+
+void BookingSystem::compact() {
+    std::lock_guard<std::mutex> lock(compactionMutex);
+    startCompaction();
+}
 
-                auto user = std::make_shared<User>(id, name, email, phone);
-                users.push_back(user);
+void BookingSystem::startCompaction() {
+    if (compactionThread.joinable()) {
+        compactionThread.join();
+    }
+    compacting = true;
+
+    Snapshot snapshot;
+    std::future<void> rotated;
+    {
+        // Запись в журнал идет под эксклюзивной блокировкой данных, поэтому
+        // снятое состояние и граница ротации журнала согласованы
+        std::shared_lock<std::shared_mutex> lock(dataMutex);
+        snapshot.users.reserve(users.size());
+        for (const auto& user : users) {
+            snapshot.users.emplace_back(user->getId(), user->getName(), user->getEmail(), user->getPhone());
+        }
+        for (const auto& event : events) {
+            if (event->getRecordType() == "Concert") {
+                snapshot.concerts.push_back(event->toRecord());
             }
+            else if (event->getRecordType() == "TheatrePlay") {
+                snapshot.plays.push_back(event->toRecord());
+            }
+            snapshot.events.push_back(event->toEventRecord());
+            snapshot.binary.addEvent(*event);
         }
-        userFile.close();
+        snapshot.tickets = ticketTable;
+
+        // Ротацию выполнит поток записи журнала; здесь только отмечается граница
+        rotated = journal->rotate();
     }
 
-    std::ifstream concertFile(dataDirectory + "concerts.txt");
-    if (concertFile.is_open()) {
-        int id, totalSeats, availableSeats, duration;
-        double basePrice;
-        std::string name, date, venue, artist, genre, description, category;
+    compactionThread = std::thread(
+        [this, snapshot = std::move(snapshot), rotated = std::move(rotated),
+        dir = dataDirectory, archive = journal->getArchivePath()]() mutable {
+            std::vector<std::string> userRecords;
+            userRecords.reserve(snapshot.users.size());
+            for (const auto& user : snapshot.users) {
+                userRecords.push_back(user.toRecord());
+                snapshot.binary.addUser(user);
+            }
 
-        std::string line;
-        while (std::getline(concertFile, line)) {
-            std::istringstream iss(line);
-            if (iss >> id >> name >> date >> venue >> totalSeats >> availableSeats >>
-                basePrice >> artist >> genre >> duration >> description >> category) {
-                nextEventId = std::max(nextEventId, id + 1);
+            std::vector<std::string> ticketRecords;
+            ticketRecords.reserve(snapshot.tickets.size());
+            for (size_t row = 0; row < snapshot.tickets.size(); row++) {
+                Ticket ticket = ticketFromRow(snapshot.tickets, row);
+                ticketRecords.push_back(ticket.toRecord());
+                snapshot.binary.addTicket(ticket);
+            }
 
-                auto concert = std::make_shared<Concert>(
-                    id, name, date, venue, totalSeats, basePrice,
-                    artist, genre, duration, description, category
-                );
-                events.push_back(concert);
+            std::string binary = snapshot.binary.serialize();
+            bool ok = Journal::writeSnapshot(dir + "snapshot.bin", binary) &&
+                Journal::writeSnapshot(dir + "users.txt", userRecords) &&
+                Journal::writeSnapshot(dir + "concerts.txt", snapshot.concerts) &&
+                Journal::writeSnapshot(dir + "theatreplays.txt", snapshot.plays) &&
+                Journal::writeSnapshot(dir + "events.txt", snapshot.events) &&
+                Journal::writeSnapshot(dir + "tickets.txt", ticketRecords);
+
+            // Архив удаляется только после того, как поток журнала закрыл его
+            rotated.wait();
+            if (ok) {
+                std::remove(archive.c_str());
+                compactionThreshold = std::max(MIN_COMPACTION_BYTES, binary.size() / 2);
             }
+            compacting = false;
+        });
+}
+
+void BookingSystem::waitForCompaction() {
+    std::lock_guard<std::mutex> lock(compactionMutex);
+    if (compactionThread.joinable()) {
+        compactionThread.join();
+    }
+}
+
+void BookingSystem::saveAllData() {
+    compact();
+    waitForCompaction();
+}
+
+void BookingSystem::applyRecord(std::string_view type, std::string_view record) {
+    if (type == "User") {
+        if (auto user = parseUser(record)) {
+            applyUser(user);
         }
-        concertFile.close();
     }
+    else if (type == "Concert") {
+        if (auto concert = parseConcert(record)) {
+            nextEventId = std::max(nextEventId.load(), concert->getId() + 1);
+            events.add(concert);
+        }
+    }
+    else if (type == "TheatrePlay") {
+        if (auto play = parseTheatrePlay(record)) {
+            nextEventId = std::max(nextEventId.load(), play->getId() + 1);
+            events.add(play);
+        }
+    }
+    else if (type == "Ticket") {
+        if (auto ticket = parseTicket(record)) {
+            applyTicket(ticket);
+        }
+    }
+}
 
-    std::ifstream playFile(dataDirectory + "theatreplays.txt");
-    if (playFile.is_open()) {
-        int id, totalSeats, availableSeats, duration, ageLimit;
-        double basePrice;
-        std::string name, date, venue, director, genre, description, category;
+void BookingSystem::applyUser(const std::shared_ptr<User>& record) {
+    nextUserId = std::max(nextUserId.load(), record->getId() + 1);
 
-        std::string line;
-        while (std::getline(playFile, line)) {
-            std::istringstream iss(line);
-            if (iss >> id >> name >> date >> venue >> totalSeats >> availableSeats >>
-                basePrice >> director >> genre >> duration >> ageLimit >> description >> category) {
-                nextEventId = std::max(nextEventId, id + 1);
+    auto user = users.find(record->getId());
+    if (user) {
+        user->setName(record->getName());
+        user->setEmail(record->getEmail());
+        user->setPhone(record->getPhone());
+    }
+    else {
+        users.add(record);
+    }
+}
 
-                auto play = std::make_shared<TheatrePlay>(
-                    id, name, date, venue, totalSeats, basePrice,
-                    director, genre, duration, ageLimit, description, category
-                );
-                events.push_back(play);
+void BookingSystem::applyTicket(const std::shared_ptr<Ticket>& record) {
+    int id = record->getId();
+    bool isActive = record->getIsActive();
+    nextTicketId = std::max(nextTicketId.load(), id + 1);
+
+    auto user = users.find(record->getUserId());
+    auto ticket = tickets.find(id);
+    if (!ticket) {
+        tickets.add(record);
+        ticketTable.append(*record);
+        indexTicket(record);
+        updateStats(record->getEventId(), record->getPrice(), &SalesStats::book);
+        if (!isActive) {
+            updateStats(record->getEventId(), record->getPrice(), &SalesStats::cancel);
+        }
+
+        if (user && isActive) {
+            user->addTicket(record);
+        }
+    }
+    else if (ticket->getIsActive() != isActive) {
+        ticket->setIsActive(isActive);
+        ticket->setCancelDateTime(record->getCancelDateTime());
+        ticketTable.setActive(tickets.slotOf(id), isActive, record->getCancelDateTime().toSeconds());
+        updateStats(ticket->getEventId(), ticket->getPrice(), isActive ? &SalesStats::restore : &SalesStats::cancel);
+
+        if (user) {
+            if (isActive) {
+                user->addTicket(ticket);
+            }
+            else {
+                user->removeTicket(id);
             }
         }
-        playFile.close();
     }
+}
 
-    std::ifstream ticketFile(dataDirectory + "tickets.txt");
-    if (ticketFile.is_open()) {
-        int id, eventId, userId;
-        double price;
-        std::string bookingTime, status;
+bool BookingSystem::loadBinarySnapshot(const std::string& path, ThreadPool& pool, LoadedData& loaded) {
+    SnapshotReader reader;
+    if (!reader.open(path)) {
+        return false;
+    }
+
+    std::vector<std::future<void>> parts;
+
+    buildInParallel(pool, reader.getUsers(), reader.getUserCount(), loaded.users, parts,
+        [&reader](const snapshot::UserRecord& r) {
+            return makePooled<User>(r.id, reader.getString(r.name),
+                reader.getString(r.email), reader.getString(r.phone));
+        });
+
+    buildInParallel(pool, reader.getEvents(), reader.getEventCount(), loaded.events, parts,
+        [&reader](const snapshot::EventRecord& r) {
+            std::shared_ptr<Event> event;
+            if (r.kind == snapshot::KIND_CONCERT) {
+                event = makePooled<Concert>(
+                    r.id, reader.getString(r.name), std::string(), reader.getString(r.venue),
+                    r.totalSeats, r.basePrice, reader.getString(r.person), reader.getString(r.genre),
+                    r.duration, reader.getString(r.description), reader.getString(r.category)
+                );
+            }
+            else {
+                event = makePooled<TheatrePlay>(
+                    r.id, reader.getString(r.name), std::string(), reader.getString(r.venue),
+                    r.totalSeats, r.basePrice, reader.getString(r.person), reader.getString(r.genre),
+                    r.duration, r.ageLimit, reader.getString(r.description), reader.getString(r.category)
+                );
+            }
+            event->setDate(DateTime::fromSeconds(r.date));
+            event->setAvailableSeats(r.availableSeats);
+            if (r.seatLayout.length > 0) {
+                event->setSeatMap(SeatMap::parse(reader.getString(r.seatLayout)));
+            }
+            return event;
+        });
+
+    buildInParallel(pool, reader.getTickets(), reader.getTicketCount(), loaded.tickets, parts,
+        [&reader](const snapshot::TicketRecord& r) {
+            auto ticket = makePooled<Ticket>(r.id, r.eventId, r.userId, r.price,
+                DateTime::fromSeconds(r.bookingTime));
+            ticket->setIsActive(r.isActive != 0);
+            ticket->setSeatId(r.seatId);
+            ticket->setCancelDateTime(DateTime::fromSeconds(r.cancelTime));
+            return ticket;
+        });
 
-        std::string line;
-        while (std::getline(ticketFile, line)) {
-            std::istringstream iss(line);
-            if (iss >> id >> eventId >> userId >> price >> bookingTime >> status) {
-                nextTicketId = std::max(nextTicketId, id + 1);
+    // Отображение файла должно жить, пока задачи читают записи
+    for (auto& part : parts) {
+        part.get();
+    }
 
-                bool isActive = (status == "active");
+    return true;
+}
 
-                auto ticket = std::make_shared<Ticket>(id, eventId, userId, price);
-                ticket->setIsActive(isActive);
-                tickets.push_back(ticket);
+void BookingSystem::loadTextSnapshot(ThreadPool& pool, LoadedData& loaded) {
+    auto userChunks = parseFileInParallel(pool, dataDirectory + "users.txt", &parseUser);
+    auto concertChunks = parseFileInParallel(pool, dataDirectory + "concerts.txt", &parseConcert);
+    auto playChunks = parseFileInParallel(pool, dataDirectory + "theatreplays.txt", &parseTheatrePlay);
+    auto ticketChunks = parseFileInParallel(pool, dataDirectory + "tickets.txt", &parseTicket);
 
-                auto userIt = std::find_if(users.begin(), users.end(),
-                    [userId](const std::shared_ptr<User>& u) {
-                        return u->getId() == userId;
-                    });
+    collectChunks(userChunks, loaded.users);
+    collectChunks(concertChunks, loaded.events);
+    collectChunks(playChunks, loaded.events);
+    collectChunks(ticketChunks, loaded.tickets);
+}
+
+void BookingSystem::linkLoadedData(const LoadedData& loaded) {
+    users.reserve(loaded.users.size());
+    for (const auto& user : loaded.users) {
+        nextUserId = std::max(nextUserId.load(), user->getId() + 1);
+        users.add(user);
+    }
+
+    events.reserve(loaded.events.size());
+    for (const auto& event : loaded.events) {
+        nextEventId = std::max(nextEventId.load(), event->getId() + 1);
+        events.add(event);
+    }
+
+    tickets.reserve(loaded.tickets.size());
+    ticketTable.reserve(loaded.tickets.size());
+    for (const auto& ticket : loaded.tickets) {
+        applyTicket(ticket);
+    }
+}
 
-                if (userIt != users.end() && isActive) {
-                    (*userIt)->addTicket(ticket);
+void BookingSystem::loadData() {
+    LoadedData loaded;
+    {
+        // Файлы и их части разбираются параллельно, связывание — в одном потоке
+        ThreadPool pool;
+        if (!loadBinarySnapshot(dataDirectory + "snapshot.bin", pool, loaded)) {
+            loadTextSnapshot(pool, loaded);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(dataMutex);
+    linkLoadedData(loaded);
+
+    // Изменения после последнего снимка восстанавливаются из журнала
+    auto apply = [this](std::string_view type, std::string_view record) {
+        applyRecord(type, record);
+    };
+    size_t replayed = Journal::replay(journal->getArchivePath(), apply) +
+        Journal::replay(journal->getPath(), apply);
+
+    // Число свободных и занятые нумерованные места определяются по активным билетам
+    std::unordered_map<int, int> soldSeats;
+    for (const auto& ticket : tickets) {
+        if (ticket->getIsActive()) {
+            soldSeats[ticket->getEventId()]++;
+            if (ticket->getSeatId() != Ticket::NO_SEAT) {
+                auto event = events.find(ticket->getEventId());
+                if (event && event->getSeatMap()) {
+                    event->getSeatMap()->take(ticket->getSeatId());
                 }
             }
         }
-        ticketFile.close();
+    }
+    for (const auto& event : events) {
+        auto it = soldSeats.find(event->getId());
+        event->setAvailableSeats(event->getTotalSeats() - (it != soldSeats.end() ? it->second : 0));
+    }
+    rebuildIndexes();
+    rebuildRollups();
+    lock.unlock();
+
+    if (replayed > 0) {
+        compact();
+    }
+    else {
+        std::error_code ec;
+        uintmax_t snapshotBytes = std::filesystem::file_size(dataDirectory + "snapshot.bin", ec);
+        if (!ec) {
+            compactionThreshold = std::max(MIN_COMPACTION_BYTES, static_cast<size_t>(snapshotBytes / 2));
+        }
     }
 
     std::cout << "Данные успешно загружены из файлов." << std::endl;
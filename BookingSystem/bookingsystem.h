@@ -4,28 +4,203 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <algorithm>
+#include <unordered_map>
 #include <iostream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <optional>
 #include "event.h"
 #include "user.h"
 #include "ticket.h"
+#include "journal.h"
+#include "registry.h"
+#include "sortedindex.h"
+#include "textindex.h"
+#include "prefixindex.h"
+#include "stringpool.h"
+#include "bitmap.h"
+#include "salesstats.h"
+#include "tickettable.h"
+#include "salesrollup.h"
+#include "poolallocator.h"
+#include "timerwheel.h"
+#include "waitlist.h"
+#include "snapshot.h"
+#include "threadpool.h"
+
+// Временное удержание мест между выбором и оплатой
+struct SeatHold {
+    int id;
+    int eventId;
+    int userId;
+    int count;
+    // Цена на момент удержания; по ней оформляются билеты
+    double price;
+    // Назначенные места, если у события есть схема зала
+    std::vector<int> seats;
+    DateTime expiresAt;
+};
 
 class BookingSystem {
 private:
-    std::vector<std::shared_ptr<Event>> events;
-    std::vector<std::shared_ptr<User>> users;
-    std::vector<std::shared_ptr<Ticket>> tickets;
-    int nextEventId = 1;
-    int nextUserId = 1;
-    int nextTicketId = 1;
+    Registry<Event> events;
+    Registry<User> users;
+    Registry<Ticket> tickets;
+    // Колоночная копия билетов для аналитики; строка совпадает с позицией в tickets
+    TicketTable ticketTable;
+    std::unordered_map<int, std::vector<std::shared_ptr<Ticket>>> ticketsByUser;
+    std::unordered_map<int, std::vector<std::shared_ptr<Ticket>>> ticketsByEvent;
+    SortedIndex<DateTime, Event> eventsByDate;
+    SortedIndex<double, Event> eventsByBasePrice;
+    SortedIndex<double, Event> eventsByEffectivePrice;
+    TextIndex eventText;
+    TextIndex userText;
+    PrefixIndex eventPrefixes;
+    // Битовые карты позиций событий в реестре по ID строки из StringPool
+    std::unordered_map<uint32_t, Bitmap> eventsByCategory;
+    std::unordered_map<uint32_t, Bitmap> eventsByGenre;
+    std::unordered_map<uint32_t, Bitmap> eventsByVenue;
+    // Итоги продаж: общие, по событиям и по ID категории из StringPool
+    SalesStats totalStats;
+    std::unordered_map<int, SalesStats> statsByEvent;
+    std::unordered_map<uint32_t, SalesStats> statsByCategory;
+    // Продажи по часам и дням: общие, по событиям и по категориям
+    SalesRollup totalRollup;
+    std::unordered_map<int, SalesRollup> rollupsByEvent;
+    std::unordered_map<uint32_t, SalesRollup> rollupsByCategory;
+    // День, на который посчитан индекс итоговых цен
+    int64_t effectivePriceDay = INT64_MIN;
+    std::atomic<int> nextEventId{ 1 };
+    std::atomic<int> nextUserId{ 1 };
+    std::atomic<int> nextTicketId{ 1 };
+    std::atomic<int> nextHoldId{ 1 };
+
+    // Действующие удержания мест и их сроки; в журнал не пишутся и после перезапуска не восстанавливаются
+    std::unordered_map<int, std::shared_ptr<SeatHold>> holds;
+    TimerWheel holdExpiry;
+
+    // Листы ожидания по ID события
+    std::unordered_map<int, Waitlist> waitlists;
+    // Записи билетов, выданных листом ожидания; их дожидается операция, освободившая места
+    std::vector<std::future<void>> promotionWrites;
+    std::atomic<int> nextWaitlistId{ 1 };
 
-    static BookingSystem* instance;
+    // Защищает реестры и индексы; запись в журнал выполняется под эксклюзивной блокировкой
+    mutable std::shared_mutex dataMutex;
+
+    static std::atomic<BookingSystem*> instance;
+    static std::mutex instanceMutex;
 
     std::string dataDirectory;
 
+    std::unique_ptr<Journal> journal;
+    std::thread compactionThread;
+    std::mutex compactionMutex;
+    // Сжатие начинается, когда журнал после последней ротации превысит половину последнего снимка
+    static constexpr size_t MIN_COMPACTION_BYTES = 1 << 20;
+    std::atomic<size_t> compactionThreshold{ MIN_COMPACTION_BYTES };
+    std::atomic<bool> compacting{ false };
+
+    // Фоновый поток, раз в секунду снимающий истекшие удержания
+    std::thread expiryThread;
+    std::mutex expiryMutex;
+    std::condition_variable expiryCondition;
+    bool stopping = false;
+
     BookingSystem();
+    ~BookingSystem();
+
+    struct LoadedData {
+        std::vector<std::shared_ptr<User>> users;
+        std::vector<std::shared_ptr<Event>> events;
+        std::vector<std::shared_ptr<Ticket>> tickets;
+    };
+
+    bool loadBinarySnapshot(const std::string& path, ThreadPool& pool, LoadedData& loaded);
+    void loadTextSnapshot(ThreadPool& pool, LoadedData& loaded);
+    void linkLoadedData(const LoadedData& loaded);
+
+    void applyRecord(std::string_view type, std::string_view record);
+    void applyUser(const std::shared_ptr<User>& record);
+    void applyTicket(const std::shared_ptr<Ticket>& record);
+
+    // Добавляет новый билет в реестр, индексы и итоги; вызывается под эксклюзивной блокировкой
+    void registerTicket(const std::shared_ptr<Ticket>& ticket, User& user);
+    // Обратное registerTicket: билет исчезает вместе с итогами, место возвращается; журнал не пишется
+    void unregisterTicket(const std::shared_ptr<Ticket>& ticket);
+    void indexTicket(const std::shared_ptr<Ticket>& ticket);
+    void unindexTicket(const std::shared_ptr<Ticket>& ticket);
+    void indexEvent(const std::shared_ptr<Event>& event);
+    void unindexEvent(const std::shared_ptr<Event>& event);
+    void rebuildIndexes();
+    void refreshEffectivePrices();
+    void updateStats(int eventId, double price, void (SalesStats::*change)(double));
+    // sign = -1 снимает ранее учтенную запись
+    void updateRollups(int eventId, const DateTime& time, double price, bool canceled, int sign = 1);
+    void rebuildRollups();
+    std::string describeSeat(const Ticket& ticket) const;
+    // Оформляет count билетов на уже зарезервированные места; записи для журнала добавляются в records
+    std::vector<std::shared_ptr<Ticket>> issueTickets(int eventId, User& user, int count, double price,
+        const std::vector<int>& seats, std::vector<std::string>& records);
+    std::shared_ptr<SeatHold> createHold(Event& event, int userId, int count, int seconds, const DateTime& now);
+    void releaseHeldSeats(const SeatHold& hold);
+    // Освободившиеся места сначала получает лист ожидания события, остаток возвращается в продажу.
+    // Эти методы вызываются под эксклюзивной блокировкой
+    void returnSeats(const std::shared_ptr<Event>& event, int count, const std::vector<int>& seats);
+    void promoteWaiters(const std::shared_ptr<Event>& event, Waitlist& waitlist);
+    size_t expireHoldsLocked(const DateTime& now);
+    void expiryLoop();
+
+    void compactIfNeeded();
+    void startCompaction();
+    // Дожидается сброса записей журнала на диск; при ошибке сообщает о ней и возвращает false
+    bool waitDurable(std::future<void>& durable);
+    // Снимает эксклюзивную блокировку и дожидается записи билетов, выданных листом ожидания
+    void waitPromotionWrites(std::unique_lock<std::shared_mutex>& lock);
+    // Убирает оформленные билеты, записи о которых не удалось сохранить, как будто их не было
+    void rollbackTickets(const std::vector<std::shared_ptr<Ticket>>& issued);
 
 public:
+    // Диапазоны индексов событий: держат версию индекса, взятую под блокировкой, и не копируют записи
+    using EventDateRange = SortedIndex<DateTime, Event>::Range;
+    using EventPriceRange = SortedIndex<double, Event>::Range;
+    using EventPriceCursor = SortedIndex<double, Event>::Cursor;
+
+    // Упорядочивание по базовой цене или по итоговой цене билета (calculateTicketPrice)
+    enum class PriceKind { BASE, EFFECTIVE };
+
+    // Условия отбора событий; пустое поле — без ограничения
+    struct EventFilter {
+        std::string category;
+        std::string genre;
+        std::string venue;
+    };
+
+    // Изменения события для updateEvent; незаданное поле не меняется
+    struct EventUpdate {
+        std::optional<std::string> name;
+        std::optional<std::string> date;
+        std::optional<std::string> venue;
+        std::optional<double> basePrice;
+        std::optional<std::string> description;
+        std::optional<std::string> category;
+    };
+
+    // Позиция корзины: событие и количество мест
+    struct CartItem {
+        std::shared_ptr<Event> event;
+        int count;
+    };
+
+    // Порядок подсказок: ближайшие предстоящие события или больше свободных мест
+    enum class SuggestionOrder { UPCOMING, AVAILABLE_SEATS };
+
     static BookingSystem& getInstance();
 
     BookingSystem(const BookingSystem&) = delete;
@@ -49,21 +224,99 @@ public:
     std::shared_ptr<Ticket> createTicket(
         std::shared_ptr<Event> event, std::shared_ptr<User> user);
 
+    // Бронирует count мест на одно событие по принципу «все или ничего»
+    std::vector<std::shared_ptr<Ticket>> createTickets(
+        std::shared_ptr<Event> event, std::shared_ptr<User> user, int count);
+
+    // Оформляет корзину из нескольких событий: места резервируются атомарно для всей корзины,
+    // цена считается один раз на событие, билеты записываются в журнал одной операцией
+    std::vector<std::shared_ptr<Ticket>> checkoutCart(
+        const std::vector<CartItem>& items, std::shared_ptr<User> user);
+
+    // false, если билета нет или он уже отменен. true означает, что отмена применена; если ее
+    // не удалось записать в журнал, выводится ошибка, а на диск она попадет со следующим снимком
     bool cancelTicket(int ticketId);
 
+    // Удерживает count мест на seconds секунд: свободных мест сразу становится меньше,
+    // места по схеме зала назначаются сразу же. Неподтвержденное удержание снимается по истечении срока
+    std::shared_ptr<const SeatHold> holdSeats(
+        std::shared_ptr<Event> event, std::shared_ptr<User> user, int count, int seconds);
+    // Оформляет удержание в билеты; пустой результат, если удержание истекло или не найдено
+    std::vector<std::shared_ptr<Ticket>> confirmHold(int holdId);
+    bool releaseHold(int holdId);
+    // Снимает истекшие удержания и возвращает их число
+    size_t expireHolds();
+    size_t getHoldCount() const;
+    // Действующие удержания пользователя, в том числе полученные из листа ожидания
+    std::vector<std::shared_ptr<const SeatHold>> getHoldsByUser(int userId) const;
+
+    // Срок удержания, которое получает заявка из листа ожидания с WaitlistPromotion::HOLD
+    static const int WAITLIST_HOLD_SECONDS = 15 * 60;
+
+    // Ставит заявку на count мест в лист ожидания события (priority 0 — высший) и возвращает ее ID.
+    // Освободившиеся места переходят к заявкам по очереди: билетом или удержанием
+    int joinWaitlist(std::shared_ptr<Event> event, std::shared_ptr<User> user, int count = 1,
+        WaitlistPromotion promotion = WaitlistPromotion::TICKET, int priority = Waitlist::PRIORITY_LEVELS - 1);
+    bool leaveWaitlist(int eventId, int entryId);
+    size_t getWaitlistSize(int eventId) const;
+
+    // Изменяет событие под блокировкой, обновляя индексы и журнал. Сеттеры Event закрыты,
+    // поэтому поля, по которым строятся индексы, меняются только здесь
+    void updateEvent(const std::shared_ptr<Event>& event, const EventUpdate& update);
+
+    // Задает схему зала вида "Партер:20,20;Балкон:15,15" (пустая строка — без нумерации мест).
+    // Число мест в схеме должно совпадать с вместимостью, а билеты на событие еще не проданы
+    bool setSeatLayout(const std::shared_ptr<Event>& event, const std::string& layout);
+    // Лучшие count соседних свободных мест без бронирования; места назначаются при бронировании
+    std::vector<int> findBestAvailableSeats(const std::shared_ptr<Event>& event, int count) const;
+    // "Партер, ряд 3, место 5" или пустая строка для билета без места
+    std::string getSeatDescription(const Ticket& ticket) const;
+
     std::shared_ptr<Event> findEventById(int id);
     std::shared_ptr<User> findUserById(int id);
     std::shared_ptr<Ticket> findTicketById(int id);
+    // Запись билета и "тип\tзапись" события, снятые под блокировкой, поэтому поля не читаются
+    // одновременно с cancelTicket и updateEvent; пустая строка, если объект не найден
+    std::string describeTicket(int id) const;
+    std::string describeEvent(int id) const;
 
+    // Поиск подстроки без учета регистра по триграммному индексу
     std::vector<std::shared_ptr<Event>> findEventsByName(const std::string& nameSubstr);
+    // Поиск по названию, месту проведения, исполнителю или режиссеру
+    std::vector<std::shared_ptr<Event>> findEventsByText(const std::string& text);
+    // Подсказки при вводе: события, где одно из слов названия, места или исполнителя начинается с prefix.
+    // Из всех совпадений возвращаются limit лучших по order
+    std::vector<std::shared_ptr<Event>> suggestEvents(const std::string& prefix, size_t limit = 10,
+        SuggestionOrder order = SuggestionOrder::UPCOMING);
     std::vector<std::shared_ptr<Event>> findEventsByCategory(const std::string& category);
-    std::vector<std::shared_ptr<Event>> findEventsByDate(const std::string& date);
-    std::vector<std::shared_ptr<Event>> getUpcomingEvents();
-    std::vector<std::shared_ptr<Event>> getEventsSortedByDate(bool ascending = true);
-    std::vector<std::shared_ptr<Event>> getEventsSortedByPrice(bool ascending = true);
+    // Сочетание условий сводится к пересечению битовых карт
+    std::vector<std::shared_ptr<Event>> findEvents(const EventFilter& filter);
+    EventDateRange findEventsByDate(const std::string& date);
+    EventDateRange getEventsBetween(const DateTime& from, const DateTime& to);
+    EventDateRange getUpcomingEvents();
+    EventDateRange getEventsSortedByDate(bool ascending = true);
+    EventPriceRange getEventsSortedByPrice(bool ascending = true, PriceKind kind = PriceKind::BASE);
+    // count самых дешевых (ascending) или самых дорогих событий
+    EventPriceRange getTopEventsByPrice(size_t count, bool ascending = true, PriceKind kind = PriceKind::BASE);
+    // То же с фильтром, например: самые дешевые предстоящие концерты
+    std::vector<std::shared_ptr<Event>> findTopEventsByPrice(size_t count, const std::function<bool(const Event&)>& filter,
+        bool ascending = true, PriceKind kind = PriceKind::BASE);
+    EventPriceRange getEventsInPriceRange(double minPrice, double maxPrice,
+        bool ascending = true, PriceKind kind = PriceKind::BASE);
+    // Постраничный обход: следующая страница начинается после курсора последней записи предыдущей
+    EventPriceRange getEventsPageByPrice(size_t pageSize, bool ascending = true, PriceKind kind = PriceKind::BASE);
+    EventPriceRange getEventsPageByPrice(const EventPriceCursor& after, size_t pageSize,
+        bool ascending = true, PriceKind kind = PriceKind::BASE);
     std::vector<std::shared_ptr<User>> findUsersByName(const std::string& nameSubstr);
-    std::vector<std::shared_ptr<Ticket>> getTicketsByUser(int userId);
-    std::vector<std::shared_ptr<Ticket>> getTicketsByEvent(int eventId);
+    // Копия списка билетов (включая отмененные), снятая под блокировкой
+    std::vector<std::shared_ptr<Ticket>> getTicketsByUser(int userId) const;
+    std::vector<std::shared_ptr<Ticket>> getTicketsByEvent(int eventId) const;
+    // Обход билетов (включая отмененные) без копирования списка. visit получает билет и его событие
+    // (nullptr, если события нет) и вызывается под разделяемой блокировкой: обращаться из него
+    // к BookingSystem нельзя
+    using TicketVisitor = std::function<void(const Ticket&, const Event*)>;
+    void forEachTicketOfUser(int userId, const TicketVisitor& visit) const;
+    void forEachTicketOfEvent(int eventId, const TicketVisitor& visit) const;
     std::vector<std::shared_ptr<Ticket>> getActiveTickets();
 
     void displayAllEvents() const;
@@ -75,9 +328,34 @@ public:
     int getCanceledTicketsCount() const;
     double getAverageTicketPrice() const;
 
+    SalesStats getSalesStats() const;
+    SalesStats getEventSalesStats(int eventId) const;
+    SalesStats getCategorySalesStats(const std::string& category) const;
+
+    // Аналитика по колоночной таблице билетов
+    double getSalesForEvent(int eventId) const;
+    double getSalesInPriceRange(double minPrice, double maxPrice) const;
+    std::vector<double> getSalesByEvent() const;
+
+    // Продажи за период по часам или дням, например за последние 7 дней по часам
+    std::vector<RollupBucket> getSalesHistory(const DateTime& from, const DateTime& to, RollupPeriod period) const;
+    std::vector<RollupBucket> getEventSalesHistory(int eventId,
+        const DateTime& from, const DateTime& to, RollupPeriod period) const;
+    std::vector<RollupBucket> getCategorySalesHistory(const std::string& category,
+        const DateTime& from, const DateTime& to, RollupPeriod period) const;
+
     void setDataDirectory(const std::string& dir);
 
-    void saveAllData() const;
+    Journal& getJournal() { return *journal; }
+
+    // Сворачивает журнал в файлы снимка в фоновом потоке
+    void compact();
+    void waitForCompaction();
+
+    void saveAllData();
     void loadData();
+
+private:
+    const SortedIndex<double, Event>& priceIndex(PriceKind kind) const;
 };
 #endif
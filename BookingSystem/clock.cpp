@@ -0,0 +1,44 @@
+#include "clock.h"
+#include <atomic>
+#include <mutex>
+#include <climits>
+
+namespace {
+    std::atomic<int64_t> localOffset{ 0 };
+    std::atomic<int64_t> refreshAt{ LLONG_MIN };
+
+    std::atomic<bool> hasSource{ false };
+    std::mutex sourceMutex;
+    Clock::Source source;
+}
+
+DateTime Clock::now() {
+    if (hasSource.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(sourceMutex);
+        if (source) {
+            return source();
+        }
+    }
+
+    // Смещение публикуется раньше срока (release), а срок читается с acquire: поток,
+    // увидевший новый срок, видит и смещение, посчитанное для него
+    int64_t t = static_cast<int64_t>(time(nullptr));
+    if (t >= refreshAt.load(std::memory_order_acquire)) {
+        int64_t offset = DateTime::fromTime(static_cast<time_t>(t)).toSeconds() - t;
+        localOffset.store(offset, std::memory_order_relaxed);
+        refreshAt.store(t + REFRESH_INTERVAL_SECONDS, std::memory_order_release);
+        return DateTime::fromSeconds(t + offset);
+    }
+
+    return DateTime::fromSeconds(t + localOffset.load(std::memory_order_relaxed));
+}
+
+void Clock::setSource(Source _source) {
+    std::lock_guard<std::mutex> lock(sourceMutex);
+    source = std::move(_source);
+    hasSource.store(static_cast<bool>(source), std::memory_order_release);
+}
+
+void Clock::resetSource() {
+    setSource(nullptr);
+}
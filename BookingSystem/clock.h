@@ -0,0 +1,21 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <functional>
+#include "datetime.h"
+
+// Источник текущего времени для горячих путей. Смещение местного времени
+// относительно UTC пересчитывается раз в минуту, поэтому now() не вызывает
+// localtime на каждом обращении. Источник можно подменить (например, в тестах).
+class Clock {
+public:
+    using Source = std::function<DateTime()>;
+
+    static const int REFRESH_INTERVAL_SECONDS = 60;
+
+    static DateTime now();
+
+    static void setSource(Source source);
+    static void resetSource();
+};
+#endif
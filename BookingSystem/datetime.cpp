@@ -1,90 +1,133 @@
 #include "datetime.h"
 #include <cstdio>
 
-DateTime::DateTime() : year(0), month(0), day(0), hour(0), minute(0), second(0) {}
-
-DateTime::DateTime(const std::string& dateTimeStr) {
-    // YYYY-MM-DD HH:MM:SS или YYYY-MM-DD
-    if (dateTimeStr.length() >= 10) {
-        try {
-            year = std::stoi(dateTimeStr.substr(0, 4));
-            month = std::stoi(dateTimeStr.substr(5, 2));
-            day = std::stoi(dateTimeStr.substr(8, 2));
-
-            if (dateTimeStr.length() >= 19) {
-                hour = std::stoi(dateTimeStr.substr(11, 2));
-                minute = std::stoi(dateTimeStr.substr(14, 2));
-                second = std::stoi(dateTimeStr.substr(17, 2));
+namespace {
+    bool parseDigits(std::string_view text, size_t pos, size_t count, int& value) {
+        value = 0;
+        for (size_t i = pos; i < pos + count; i++) {
+            if (text[i] < '0' || text[i] > '9') {
+                return false;
             }
-            else {
-                hour = 0;
-                minute = 0;
-                second = 0;
-            }
-        }
-        catch (const std::exception& e) {
-            year = 0; month = 0; day = 0;
-            hour = 0; minute = 0; second = 0;
+            value = value * 10 + (text[i] - '0');
         }
+        return true;
+    }
+
+    int64_t floorDiv(int64_t value, int64_t divisor) {
+        int64_t result = value / divisor;
+        return (value % divisor < 0) ? result - 1 : result;
     }
-    else {
-        year = 0; month = 0; day = 0;
-        hour = 0; minute = 0; second = 0;
+
+    // Преобразования между календарной датой и номером дня от 1970-01-01
+    int64_t daysFromCivil(int64_t year, int month, int day) {
+        year -= month <= 2;
+        const int64_t era = (year >= 0 ? year : year - 399) / 400;
+        const int64_t yearOfEra = year - era * 400;
+        const int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    void civilFromDays(int64_t days, int& year, int& month, int& day) {
+        days += 719468;
+        const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        const int64_t dayOfEra = days - era * 146097;
+        const int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const int64_t mp = (5 * dayOfYear + 2) / 153;
+        day = static_cast<int>(dayOfYear - (153 * mp + 2) / 5 + 1);
+        month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+        year = static_cast<int>(yearOfEra + era * 400 + (month <= 2));
     }
 }
 
-DateTime DateTime::now() {
-    DateTime dt;
-    time_t t = time(nullptr);
-    struct tm timeinfo;
+DateTime::DateTime() : seconds(INVALID) {}
 
-    localtime_s(&timeinfo, &t);
+DateTime::DateTime(std::string_view dateTimeStr) : seconds(INVALID) {
+    // YYYY-MM-DD HH:MM:SS или YYYY-MM-DD; позиции полей фиксированы
+    if (dateTimeStr.length() < 10) {
+        return;
+    }
 
-    dt.year = timeinfo.tm_year + 1900;
-    dt.month = timeinfo.tm_mon + 1;
-    dt.day = timeinfo.tm_mday;
-    dt.hour = timeinfo.tm_hour;
-    dt.minute = timeinfo.tm_min;
-    dt.second = timeinfo.tm_sec;
+    int y, mo, d, h = 0, mi = 0, sec = 0;
+    if (!parseDigits(dateTimeStr, 0, 4, y) || !parseDigits(dateTimeStr, 5, 2, mo) ||
+        !parseDigits(dateTimeStr, 8, 2, d)) {
+        return;
+    }
+
+    if (dateTimeStr.length() >= 19 &&
+        (!parseDigits(dateTimeStr, 11, 2, h) || !parseDigits(dateTimeStr, 14, 2, mi) ||
+            !parseDigits(dateTimeStr, 17, 2, sec))) {
+        return;
+    }
 
-    return dt;
+    *this = fromFields(y, mo, d, h, mi, sec);
 }
 
-std::string DateTime::toString() const {
-    char buffer[20];
-    sprintf_s(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d",
-        year, month, day, hour, minute, second);
-    return std::string(buffer);
+DateTime DateTime::fromFields(int year, int month, int day, int hour, int minute, int second) {
+    if (month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60) {
+        return DateTime();
+    }
+
+    return DateTime(daysFromCivil(year, month, day) * SECONDS_PER_DAY +
+        hour * SECONDS_PER_HOUR + minute * SECONDS_PER_MINUTE + second);
 }
 
-std::string DateTime::toDateString() const {
-    char buffer[11];
-    sprintf_s(buffer, sizeof(buffer), "%04d-%02d-%02d", year, month, day);
-    return std::string(buffer);
+DateTime DateTime::now() {
+    return fromTime(time(nullptr));
+}
+
+DateTime DateTime::fromTime(time_t t) {
+    struct tm timeinfo;
+
+    localtime_s(&timeinfo, &t);
+
+    return fromFields(timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
+        timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
 }
 
-bool DateTime::operator<(const DateTime& other) const {
-    if (year != other.year) return year < other.year;
-    if (month != other.month) return month < other.month;
-    if (day != other.day) return day < other.day;
-    if (hour != other.hour) return hour < other.hour;
-    if (minute != other.minute) return minute < other.minute;
-    return second < other.second;
+int64_t DateTime::getDay() const {
+    return floorDiv(seconds, SECONDS_PER_DAY);
 }
 
-bool DateTime::operator>(const DateTime& other) const {
-    return other < *this;
+int64_t DateTime::getHour() const {
+    return floorDiv(seconds, SECONDS_PER_HOUR);
 }
 
-bool DateTime::operator==(const DateTime& other) const {
-    return year == other.year && month == other.month && day == other.day &&
-        hour == other.hour && minute == other.minute && second == other.second;
+int DateTime::getWeekday() const {
+    // 1970-01-01 — четверг
+    int64_t weekday = (getDay() + 4) % 7;
+    return static_cast<int>(weekday < 0 ? weekday + 7 : weekday);
 }
 
-bool DateTime::operator<=(const DateTime& other) const {
-    return *this < other || *this == other;
+std::string DateTime::toString() const {
+    if (!isValid()) {
+        return "0000-00-00 00:00:00";
+    }
+
+    int year, month, day;
+    civilFromDays(getDay(), year, month, day);
+    int64_t timeOfDay = seconds - getDay() * SECONDS_PER_DAY;
+
+    char buffer[32];
+    sprintf_s(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d",
+        year, month, day,
+        static_cast<int>(timeOfDay / SECONDS_PER_HOUR),
+        static_cast<int>(timeOfDay % SECONDS_PER_HOUR / SECONDS_PER_MINUTE),
+        static_cast<int>(timeOfDay % SECONDS_PER_MINUTE));
+    return std::string(buffer);
 }
 
-bool DateTime::operator>=(const DateTime& other) const {
-    return *this > other || *this == other;
+std::string DateTime::toDateString() const {
+    if (!isValid()) {
+        return "0000-00-00";
+    }
+
+    int year, month, day;
+    civilFromDays(getDay(), year, month, day);
+
+    char buffer[16];
+    sprintf_s(buffer, sizeof(buffer), "%04d-%02d-%02d", year, month, day);
+    return std::string(buffer);
 }
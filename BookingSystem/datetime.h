@@ -2,31 +2,54 @@
 #define DATETIME_H
 
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <ctime>
 
+// Дата и время хранятся одним числом — секундами от 1970-01-01 00:00:00
+// (местное время, без учета часового пояса); сравнение сводится к одному сравнению чисел.
 class DateTime {
 private:
-    int year;
-    int month;
-    int day;
-    int hour;
-    int minute;
-    int second;
+    static constexpr int64_t INVALID = INT64_MIN;
+
+    int64_t seconds;
+
+    explicit DateTime(int64_t _seconds) : seconds(_seconds) {}
 
 public:
+    static constexpr int64_t SECONDS_PER_MINUTE = 60;
+    static constexpr int64_t SECONDS_PER_HOUR = 3600;
+    static constexpr int64_t SECONDS_PER_DAY = 86400;
+
     DateTime();
-    DateTime(const std::string& dateTimeStr);
+    DateTime(std::string_view dateTimeStr);
 
     static DateTime now();
+    static DateTime fromTime(time_t t);
+    static DateTime fromFields(int year, int month, int day, int hour = 0, int minute = 0, int second = 0);
+    static DateTime fromSeconds(int64_t seconds) { return DateTime(seconds); }
+
+    bool isValid() const { return seconds != INVALID; }
+    int64_t toSeconds() const { return seconds; }
+
+    // Номер дня и часа от начала эпохи — для группировки по дням и часам
+    int64_t getDay() const;
+    int64_t getHour() const;
+
+    // День недели: 0 — воскресенье, 6 — суббота
+    int getWeekday() const;
+
+    DateTime addSeconds(int64_t delta) const { return isValid() ? DateTime(seconds + delta) : *this; }
 
     std::string toString() const;
     std::string toDateString() const;
 
-    bool operator<(const DateTime& other) const;
-    bool operator>(const DateTime& other) const;
-    bool operator==(const DateTime& other) const;
-    bool operator<=(const DateTime& other) const;
-    bool operator>=(const DateTime& other) const;
+    bool operator<(const DateTime& other) const { return seconds < other.seconds; }
+    bool operator>(const DateTime& other) const { return seconds > other.seconds; }
+    bool operator==(const DateTime& other) const { return seconds == other.seconds; }
+    bool operator!=(const DateTime& other) const { return seconds != other.seconds; }
+    bool operator<=(const DateTime& other) const { return seconds <= other.seconds; }
+    bool operator>=(const DateTime& other) const { return seconds >= other.seconds; }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -2,8 +2,9 @@
 #include "user.h"
 #include "ticket.h"
 #include "bookingsystem.h"
-#include <fstream>
+#include "clock.h"
 #include <sstream>
+#include <algorithm>
 
 Event::Event(int _id, const std::string& _name, const std::string& _date,
     const std::string& _venue, int _totalSeats, double _basePrice,
@@ -14,7 +15,7 @@ Event::Event(int _id, const std::string& _name, const std::string& _date,
 }
 
 bool Event::isExpired() const {
-    return eventDate < DateTime::now();
+    return eventDate < Clock::now();
 }
 
 double Event::calculateTicketPrice() const {
@@ -31,75 +32,64 @@ void Event::display() const {
     std::cout << "Название: " << name << "\n";
     std::cout << "Дата: " << eventDate.toDateString() << "\n";
     std::cout << "Место проведения: " << venue << "\n";
-    std::cout << "Доступно мест: " << availableSeats << " из " << totalSeats << "\n";
+    std::cout << "Доступно мест: " << getAvailableSeats() << " из " << totalSeats << "\n";
     std::cout << "Базовая цена: " << basePrice << " руб.\n";
     if (!description.empty()) {
         std::cout << "Описание: " << description << "\n";
     }
     std::cout << "Категория: " << category << "\n";
+    if (seatMap) {
+        std::cout << "Схема зала: " << seatMap->getLayout() << "\n";
+    }
     std::cout << "Статус: " << (isExpired() ? "Прошедшее" : "Предстоящее") << "\n";
 }
 
-void Event::decreaseAvailableSeats() {
-    if (availableSeats > 0) {
-        availableSeats--;
+bool Event::tryReserve(int count) {
+    if (count <= 0) {
+        return false;
     }
-}
 
-void Event::increaseAvailableSeats() {
-    if (availableSeats < totalSeats) {
-        availableSeats++;
+    int current = availableSeats.load(std::memory_order_relaxed);
+    while (current >= count) {
+        if (availableSeats.compare_exchange_weak(current, current - count,
+            std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            return true;
+        }
     }
+    return false;
 }
 
-void Event::saveToFile() const {
-    bool exists = false;
-    int lineToReplace = -1;
-    std::string line;
-    std::ifstream inFile("events.txt");
-    std::vector<std::string> lines;
+void Event::release(int count) {
+    int current = availableSeats.load(std::memory_order_relaxed);
+    int updated;
+    do {
+        updated = std::min(current + count, totalSeats);
+    } while (!availableSeats.compare_exchange_weak(current, updated,
+        std::memory_order_acq_rel, std::memory_order_relaxed));
+}
 
-    if (inFile.is_open()) {
-        int lineNum = 0;
-        while (std::getline(inFile, line)) {
-            lines.push_back(line);
-            std::istringstream iss(line);
-            std::string type;
-            int eventId;
-            iss >> type >> eventId;
-            if (type == "Event" && eventId == id) {
-                exists = true;
-                lineToReplace = lineNum;
-            }
-            lineNum++;
-        }
-        inFile.close();
-    }
+void Event::decreaseAvailableSeats() {
+    tryReserve(1);
+}
 
-    if (exists) {
-        std::ostringstream newLine;
-        newLine << "Event\t" << id << "\t" << name << "\t" << eventDate.toDateString() << "\t"
-            << venue << "\t" << totalSeats << "\t" << availableSeats << "\t"
-            << basePrice << "\t" << description << "\t" << category;
-        lines[lineToReplace] = newLine.str();
+void Event::increaseAvailableSeats() {
+    release(1);
+}
 
-        std::ofstream outFile("events.txt", std::ios::trunc);
-        if (outFile.is_open()) {
-            for (const auto& l : lines) {
-                outFile << l << std::endl;
-            }
-            outFile.close();
-        }
-    }
-    else {
-        std::ofstream file("events.txt", std::ios::app);
-        if (file.is_open()) {
-            file << "Event\t" << id << "\t" << name << "\t" << eventDate.toDateString() << "\t"
-                << venue << "\t" << totalSeats << "\t" << availableSeats << "\t"
-                << basePrice << "\t" << description << "\t" << category << std::endl;
-            file.close();
-        }
-    }
+std::string Event::toEventRecord() const {
+    std::ostringstream record;
+    record << "Event\t" << id << "\t" << name << "\t" << eventDate.toDateString() << "\t"
+        << venue << "\t" << totalSeats << "\t" << getAvailableSeats() << "\t"
+        << basePrice << "\t" << description << "\t" << category << "\t" << getSeatLayout();
+    return record.str();
+}
+
+std::string Event::toRecord() const {
+    return toEventRecord();
+}
+
+void Event::saveToFile() const {
+    BookingSystem::getInstance().getJournal().append(getRecordType(), toRecord());
 }
 
 Concert::Concert(int _id, const std::string& _name, const std::string& _date,
@@ -114,13 +104,7 @@ Concert::Concert(int _id, const std::string& _name, const std::string& _date,
 double Concert::calculateTicketPrice() const {
     double price = basePrice * 1.1;
 
-    DateTime dt = getEventDate();
-    time_t t = time(nullptr);
-    struct tm timeinfo;
-
-    localtime_s(&timeinfo, &t);
-
-    int weekday = timeinfo.tm_wday;
+    int weekday = Clock::now().getWeekday();
     if (weekday == 0 || weekday == 5 || weekday == 6) {
         price *= 1.05;
     }
@@ -135,57 +119,13 @@ void Concert::display() const {
     std::cout << "Продолжительность: " << duration << " мин.\n";
 }
 
-void Concert::saveToFile() const {
-    bool exists = false;
-    int lineToReplace = -1;
-    std::string line;
-    std::ifstream inFile("concerts.txt");
-    std::vector<std::string> lines;
-
-    if (inFile.is_open()) {
-        int lineNum = 0;
-        while (std::getline(inFile, line)) {
-            lines.push_back(line);
-            std::istringstream iss(line);
-            int eventId;
-            iss >> eventId;
-            if (eventId == id) {
-                exists = true;
-                lineToReplace = lineNum;
-            }
-            lineNum++;
-        }
-        inFile.close();
-    }
-
-    if (exists) {
-        std::ostringstream newLine;
-        newLine << id << "\t" << name << "\t" << eventDate.toDateString() << "\t" << venue << "\t"
-            << totalSeats << "\t" << availableSeats << "\t" << basePrice << "\t"
-            << artist << "\t" << genre << "\t" << duration << "\t"
-            << description << "\t" << category;
-        lines[lineToReplace] = newLine.str();
-
-        std::ofstream outFile("concerts.txt", std::ios::trunc);
-        if (outFile.is_open()) {
-            for (const auto& l : lines) {
-                outFile << l << std::endl;
-            }
-            outFile.close();
-        }
-    }
-    else {
-        std::ofstream file("concerts.txt", std::ios::app);
-        if (file.is_open()) {
-            file << id << "\t" << name << "\t" << eventDate.toDateString() << "\t" << venue << "\t"
-                << totalSeats << "\t" << availableSeats << "\t" << basePrice << "\t"
-                << artist << "\t" << genre << "\t" << duration << "\t"
-                << description << "\t" << category << std::endl;
-            file.close();
-        }
-    }
-
-    Event::saveToFile();
+std::string Concert::toRecord() const {
+    std::ostringstream record;
+    record << id << "\t" << name << "\t" << eventDate.toDateString() << "\t" << venue << "\t"
+        << totalSeats << "\t" << getAvailableSeats() << "\t" << basePrice << "\t"
+        << artist << "\t" << genre << "\t" << duration << "\t"
+        << description << "\t" << category << "\t" << getSeatLayout();
+    return record.str();
 }
 
 TheatrePlay::TheatrePlay(int _id, const std::string& _name, const std::string& _date,
@@ -215,55 +155,11 @@ void TheatrePlay::display() const {
     std::cout << "Возрастное ограничение: " << (ageLimit > 0 ? std::to_string(ageLimit) + "+" : "Без ограничений") << "\n";
 }
 
-void TheatrePlay::saveToFile() const {
-    bool exists = false;
-    int lineToReplace = -1;
-    std::string line;
-    std::ifstream inFile("theatreplays.txt");
-    std::vector<std::string> lines;
-
-    if (inFile.is_open()) {
-        int lineNum = 0;
-        while (std::getline(inFile, line)) {
-            lines.push_back(line);
-            std::istringstream iss(line);
-            int eventId;
-            iss >> eventId;
-            if (eventId == id) {
-                exists = true;
-                lineToReplace = lineNum;
-            }
-            lineNum++;
-        }
-        inFile.close();
-    }
-
-    if (exists) {
-        std::ostringstream newLine;
-        newLine << id << "\t" << name << "\t" << eventDate.toDateString() << "\t" << venue << "\t"
-            << totalSeats << "\t" << availableSeats << "\t" << basePrice << "\t"
-            << director << "\t" << genre << "\t" << duration << "\t" << ageLimit << "\t"
-            << description << "\t" << category;
-        lines[lineToReplace] = newLine.str();
-
-        std::ofstream outFile("theatreplays.txt", std::ios::trunc);
-        if (outFile.is_open()) {
-            for (const auto& l : lines) {
-                outFile << l << std::endl;
-            }
-            outFile.close();
-        }
-    }
-    else {
-        std::ofstream file("theatreplays.txt", std::ios::app);
-        if (file.is_open()) {
-            file << id << "\t" << name << "\t" << eventDate.toDateString() << "\t" << venue << "\t"
-                << totalSeats << "\t" << availableSeats << "\t" << basePrice << "\t"
-                << director << "\t" << genre << "\t" << duration << "\t" << ageLimit << "\t"
-                << description << "\t" << category << std::endl;
-            file.close();
-        }
-    }
-
-    Event::saveToFile();
+std::string TheatrePlay::toRecord() const {
+    std::ostringstream record;
+    record << id << "\t" << name << "\t" << eventDate.toDateString() << "\t" << venue << "\t"
+        << totalSeats << "\t" << getAvailableSeats() << "\t" << basePrice << "\t"
+        << director << "\t" << genre << "\t" << duration << "\t" << ageLimit << "\t"
+        << description << "\t" << category << "\t" << getSeatLayout();
+    return record.str();
 }
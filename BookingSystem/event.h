@@ -5,24 +5,31 @@
 #include <vector>
 #include <memory>
 #include <iostream>
+#include <atomic>
 #include "interfaces.h"
 #include "datetime.h"
+#include "stringpool.h"
+#include "seatmap.h"
 
 class Ticket;
 class User;
 class BookingSystem;
 
 class Event : public IIdentifiable, public IStorable, public std::enable_shared_from_this<Event> {
+    // Поля, по которым строятся индексы, меняются только через BookingSystem::updateEvent
+    friend class BookingSystem;
+
 protected:
     std::string name;
     DateTime eventDate;
-    std::string venue;
+    InternedString venue;
     int totalSeats;
-    int availableSeats;
+    std::atomic<int> availableSeats;
     double basePrice;
     std::vector<std::shared_ptr<Ticket>> tickets;
     std::string description;
-    std::string category;
+    InternedString category;
+    std::unique_ptr<SeatMap> seatMap;
 
 public:
     Event(int _id, const std::string& _name, const std::string& _date,
@@ -36,17 +43,27 @@ public:
     std::string getDate() const { return eventDate.toDateString(); }
     const std::string& getVenue() const { return venue; }
     int getTotalSeats() const { return totalSeats; }
-    int getAvailableSeats() const { return availableSeats; }
+    int getAvailableSeats() const { return availableSeats.load(std::memory_order_acquire); }
     double getBasePrice() const { return basePrice; }
     const std::string& getDescription() const { return description; }
     const std::string& getCategory() const { return category; }
+    // Жанр есть у концертов и спектаклей; у базового события он пустой
+    virtual const std::string& getGenre() const { return InternedString().str(); }
 
-    void setName(const std::string& _name) { name = _name; }
-    void setDate(const std::string& _date) { eventDate = DateTime(_date); }
-    void setVenue(const std::string& _venue) { venue = _venue; }
-    void setBasePrice(double _price) { basePrice = _price; }
-    void setDescription(const std::string& _description) { description = _description; }
-    void setCategory(const std::string& _category) { category = _category; }
+    // ID строк в StringPool для индексов и итогов без повторного обращения к словарю
+    uint32_t getVenueId() const { return venue.id(); }
+    uint32_t getCategoryId() const { return category.id(); }
+    virtual uint32_t getGenreId() const {
+        static const uint32_t EMPTY = InternedString().id();
+        return EMPTY;
+    }
+
+    void setAvailableSeats(int _availableSeats) { availableSeats.store(_availableSeats, std::memory_order_release); }
+
+    // Схема зала с нумерованными местами; nullptr, если места не нумеруются
+    SeatMap* getSeatMap() const { return seatMap.get(); }
+    std::string getSeatLayout() const { return seatMap ? seatMap->getLayout() : std::string(); }
+    void setSeatMap(std::unique_ptr<SeatMap> _seatMap) { seatMap = std::move(_seatMap); }
 
     bool isExpired() const;
 
@@ -54,19 +71,45 @@ public:
 
     virtual std::shared_ptr<Ticket> createTicket(std::shared_ptr<User> user);
 
+    // Поля для полнотекстового поиска; первым всегда идет название
+    virtual std::vector<std::string> getSearchFields() const { return { name, venue }; }
+
+    virtual std::string getRecordType() const { return "Event"; }
+
+    virtual std::string toRecord() const;
+
+    std::string toEventRecord() const;
+
     void saveToFile() const override;
 
     virtual void display() const;
 
+    // Резервирует count мест без блокировок; при нехватке мест ничего не меняет
+    bool tryReserve(int count = 1);
+
+    // Возвращает count мест, не превышая общее количество
+    void release(int count = 1);
+
     void decreaseAvailableSeats();
 
     void increaseAvailableSeats();
+
+private:
+    void setName(const std::string& _name) { name = _name; }
+    void setDate(const std::string& _date) { eventDate = DateTime(_date); }
+    void setDate(const DateTime& _date) { eventDate = _date; }
+    void setVenue(const std::string& _venue) { venue = _venue; }
+    void setBasePrice(double _price) { basePrice = _price; }
+    void setDescription(const std::string& _description) { description = _description; }
+    void setCategory(const std::string& _category) { category = _category; }
 };
 
 class Concert : public Event {
+    friend class BookingSystem;
+
 private:
-    std::string artist;
-    std::string genre;
+    InternedString artist;
+    InternedString genre;
     int duration;
 
 public:
@@ -81,20 +124,28 @@ public:
     void display() const override;
 
     const std::string& getArtist() const { return artist; }
-    const std::string& getGenre() const { return genre; }
+    const std::string& getGenre() const override { return genre; }
+    uint32_t getGenreId() const override { return genre.id(); }
     int getDuration() const { return duration; }
 
+    std::vector<std::string> getSearchFields() const override { return { name, venue, artist }; }
+
+    std::string getRecordType() const override { return "Concert"; }
+
+    std::string toRecord() const override;
+
+private:
     void setArtist(const std::string& _artist) { artist = _artist; }
     void setGenre(const std::string& _genre) { genre = _genre; }
     void setDuration(int _duration) { duration = _duration; }
-
-    void saveToFile() const override;
 };
 
 class TheatrePlay : public Event {
+    friend class BookingSystem;
+
 private:
     std::string director;
-    std::string genre;
+    InternedString genre;
     int duration;
     int ageLimit;
 
@@ -110,15 +161,21 @@ public:
     void display() const override;
 
     const std::string& getDirector() const { return director; }
-    const std::string& getGenre() const { return genre; }
+    const std::string& getGenre() const override { return genre; }
+    uint32_t getGenreId() const override { return genre.id(); }
     int getDuration() const { return duration; }
     int getAgeLimit() const { return ageLimit; }
 
+    std::vector<std::string> getSearchFields() const override { return { name, venue, director }; }
+
+    std::string getRecordType() const override { return "TheatrePlay"; }
+
+    std::string toRecord() const override;
+
+private:
     void setDirector(const std::string& _director) { director = _director; }
     void setGenre(const std::string& _genre) { genre = _genre; }
     void setDuration(int _duration) { duration = _duration; }
     void setAgeLimit(int _ageLimit) { ageLimit = _ageLimit; }
-
-    void saveToFile() const override;
 };
 #endif
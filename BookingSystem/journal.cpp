@@ -0,0 +1,323 @@
+#include "journal.h"
+#include "recordreader.h"
+#include <fstream>
+#include <iterator>
+#include <charconv>
+#include <filesystem>
+#include <stdexcept>
+#include <io.h>
+
+Journal::Journal(const std::string& _path)
+    : path(_path), file(nullptr), recordCount(0), byteCount(0),
+    rotationPending(false), rotationOffset(0), rotationWaiters(0), writing(false), stopping(false) {
+    open();
+    writer = std::thread(&Journal::writerLoop, this);
+}
+
+Journal::~Journal() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    pendingCondition.notify_all();
+    writer.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    close();
+}
+
+void Journal::open() {
+    // Если последняя запись оборвалась при сбое, начинаем новую с новой строки
+    bool needsNewline = false;
+    FILE* existing = nullptr;
+    if (fopen_s(&existing, path.c_str(), "rb") == 0 && existing) {
+        if (fseek(existing, -1, SEEK_END) == 0) {
+            needsNewline = fgetc(existing) != '\n';
+        }
+        fclose(existing);
+    }
+
+    if (fopen_s(&file, path.c_str(), "ab") != 0) {
+        file = nullptr;
+        return;
+    }
+
+    if (needsNewline) {
+        fputc('\n', file);
+    }
+}
+
+void Journal::close() {
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+void Journal::formatRecord(std::string& out, const std::string& type, const std::string& payload) {
+    size_t start = out.size();
+    out += type;
+    out += '\t';
+    out += payload;
+
+    char crc[16];
+    sprintf_s(crc, sizeof(crc), "\t%08x\n", checksum(std::string_view(out).substr(start)));
+    out += crc;
+}
+
+void Journal::append(const std::string& type, const std::string& payload) {
+    std::string body;
+    formatRecord(body, type, payload);
+    enqueue(std::move(body), 1, false);
+}
+
+std::future<void> Journal::appendDurable(const std::string& type, const std::string& payload) {
+    std::string body;
+    formatRecord(body, type, payload);
+    return enqueue(std::move(body), 1, true);
+}
+
+std::future<void> Journal::appendBatchDurable(const std::string& type, const std::vector<std::string>& payloads) {
+    std::string body;
+    for (const auto& payload : payloads) {
+        formatRecord(body, type, payload);
+    }
+    return enqueue(std::move(body), payloads.size(), true);
+}
+
+std::future<void> Journal::enqueue(std::string&& data, size_t records, bool waitable) {
+    std::future<void> done;
+    size_t bytes = data.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pendingData.empty()) {
+            pendingData = std::move(data);
+        }
+        else {
+            pendingData += data;
+        }
+        if (waitable) {
+            waiters.emplace_back();
+            done = waiters.back().get_future();
+        }
+        recordCount += records;
+        byteCount += bytes;
+    }
+    pendingCondition.notify_one();
+    return done;
+}
+
+void Journal::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        pendingCondition.wait(lock, [this] {
+            return stopping || !pendingData.empty() || !waiters.empty() || rotationPending;
+        });
+        if (pendingData.empty() && waiters.empty() && !rotationPending) {
+            return;
+        }
+
+        // Все, что накопилось за время предыдущего сброса, уходит одной группой
+        std::string data;
+        data.swap(pendingData);
+        std::vector<std::promise<void>> done;
+        done.swap(waiters);
+        bool rotation = rotationPending;
+        size_t offset = rotationOffset;
+        size_t archivedWaiters = rotationWaiters;
+        std::promise<void> rotated = std::move(rotationDone);
+        rotationPending = false;
+        writing = true;
+        lock.unlock();
+
+        if (rotation) {
+            // Группа делится границей ротации: начало дописывается в старый файл, остаток — в новый
+            std::vector<std::promise<void>> archived(std::make_move_iterator(done.begin()),
+                std::make_move_iterator(done.begin() + archivedWaiters));
+            done.erase(done.begin(), done.begin() + archivedWaiters);
+            writeGroup(data.substr(0, offset), archived);
+            switchToNewFile();
+            rotated.set_value();
+            data.erase(0, offset);
+        }
+        if (!data.empty() || !done.empty()) {
+            writeGroup(data, done);
+        }
+
+        lock.lock();
+        writing = false;
+        idleCondition.notify_all();
+    }
+}
+
+void Journal::writeGroup(const std::string& data, std::vector<std::promise<void>>& done) {
+    bool written = writeAndSync(data);
+    notifyWaiters(done, written);
+}
+
+bool Journal::writeAndSync(const std::string& data) {
+    // Файл мог не открыться раньше или быть закрыт после сбоя записи
+    if (!file) {
+        open();
+        if (!file) {
+            return false;
+        }
+    }
+
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size() &&
+        fflush(file) == 0 && _commit(_fileno(file)) == 0;
+    if (!ok) {
+        // При повторном открытии оборванная запись будет завершена переводом строки
+        fclose(file);
+        file = nullptr;
+    }
+    return ok;
+}
+
+void Journal::notifyWaiters(std::vector<std::promise<void>>& done, bool written) const {
+    for (auto& waiter : done) {
+        if (written) {
+            waiter.set_value();
+        }
+        else {
+            waiter.set_exception(std::make_exception_ptr(
+                std::runtime_error("не удалось записать журнал " + path)));
+        }
+    }
+}
+
+void Journal::sync() {
+    enqueue(std::string(), 0, true).wait();
+}
+
+std::future<void> Journal::rotate() {
+    std::future<void> done;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // Предыдущая ротация должна завершиться: граница в очереди одна
+        idleCondition.wait(lock, [this] { return !rotationPending; });
+        rotationPending = true;
+        rotationOffset = pendingData.size();
+        rotationWaiters = waiters.size();
+        rotationDone = std::promise<void>();
+        done = rotationDone.get_future();
+        recordCount = 0;
+        byteCount = 0;
+    }
+    pendingCondition.notify_one();
+    return done;
+}
+
+void Journal::switchToNewFile() {
+    close();
+
+    std::string archivePath = getArchivePath();
+    std::error_code ec;
+    if (std::filesystem::exists(archivePath, ec)) {
+        // Предыдущее сжатие не завершилось — дописываем записи к старому архиву
+        std::ifstream inFile(path, std::ios::binary);
+        std::ofstream outFile(archivePath, std::ios::binary | std::ios::app);
+        if (inFile.is_open() && outFile.is_open()) {
+            outFile << inFile.rdbuf();
+        }
+        inFile.close();
+        outFile.close();
+        std::filesystem::remove(path, ec);
+    }
+    else {
+        std::filesystem::rename(path, archivePath, ec);
+    }
+
+    open();
+}
+
+uint32_t Journal::checksum(std::string_view data) {
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char ch : data) {
+        crc = table[(crc ^ ch) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+size_t Journal::replay(const std::string& path,
+    const std::function<void(std::string_view, std::string_view)>& apply) {
+    std::ifstream inFile(path, std::ios::binary);
+    if (!inFile.is_open()) {
+        return 0;
+    }
+
+    std::string content((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+    LineReader lines(content);
+
+    size_t count = 0;
+    std::string_view line;
+    while (lines.next(line)) {
+        size_t typeEnd = line.find('\t');
+        size_t crcPos = line.rfind('\t');
+        if (typeEnd == std::string_view::npos || typeEnd == crcPos) {
+            continue;
+        }
+
+        std::string_view body = line.substr(0, crcPos);
+        std::string_view crcText = line.substr(crcPos + 1);
+        uint32_t stored = 0;
+        auto parsed = std::from_chars(crcText.data(), crcText.data() + crcText.size(), stored, 16);
+        if (parsed.ec != std::errc() || stored != checksum(body)) {
+            // Запись повреждена (оборвалась при сбое) — пропускаем ее
+            continue;
+        }
+
+        apply(body.substr(0, typeEnd), body.substr(typeEnd + 1));
+        count++;
+    }
+
+    return count;
+}
+
+bool Journal::writeSnapshot(const std::string& path, const std::string& data) {
+    std::string tmpPath = path + ".tmp";
+    FILE* out = nullptr;
+    if (fopen_s(&out, tmpPath.c_str(), "wb") != 0 || !out) {
+        return false;
+    }
+
+    bool ok = fwrite(data.data(), 1, data.size(), out) == data.size() &&
+        fflush(out) == 0 && _commit(_fileno(out)) == 0;
+    fclose(out);
+
+    std::error_code ec;
+    if (ok) {
+        std::filesystem::rename(tmpPath, path, ec);
+    }
+    else {
+        std::filesystem::remove(tmpPath, ec);
+    }
+    return ok && !ec;
+}
+
+bool Journal::writeSnapshot(const std::string& path, const std::vector<std::string>& lines) {
+    size_t total = 0;
+    for (const auto& l : lines) {
+        total += l.size() + 1;
+    }
+
+    std::string data;
+    data.reserve(total);
+    for (const auto& l : lines) {
+        data += l;
+        data += '\n';
+    }
+    return writeSnapshot(path, data);
+}
@@ -0,0 +1,93 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <future>
+#include <condition_variable>
+
+// Журнал изменений: каждая запись дописывается в конец файла одной строкой
+// "тип\tданные\tcrc32". Записи копятся в очереди, фоновый поток сбрасывает их
+// группами: одна запись в файл и один сброс на диск на всю группу.
+// Если группу записать не удалось, ожидающие ее future получают исключение
+// std::runtime_error, а файл открывается заново перед следующей группой.
+// Ротация тоже выполняется фоновым потоком в порядке очереди, поэтому не задерживает вызывающего.
+class Journal {
+private:
+    std::string path;
+    FILE* file;
+    std::atomic<size_t> recordCount;
+    std::atomic<size_t> byteCount;
+
+    std::mutex mutex;
+    std::condition_variable pendingCondition;
+    std::condition_variable idleCondition;
+    std::string pendingData;
+    std::vector<std::promise<void>> waiters;
+    // Запрошенная ротация: записи и ожидающие до этих позиций очереди уходят в архив
+    bool rotationPending;
+    size_t rotationOffset;
+    size_t rotationWaiters;
+    std::promise<void> rotationDone;
+    bool writing;
+    bool stopping;
+    std::thread writer;
+
+    void open();
+    void close();
+    void writerLoop();
+    void writeGroup(const std::string& data, std::vector<std::promise<void>>& done);
+    // Закрывает файл, переносит его в архив и открывает новый; вызывается фоновым потоком
+    void switchToNewFile();
+    // false, если файл не открыт или запись и сброс на диск не удались; файл тогда закрывается
+    bool writeAndSync(const std::string& data);
+    void notifyWaiters(std::vector<std::promise<void>>& done, bool written) const;
+    std::future<void> enqueue(std::string&& data, size_t records, bool waitable);
+
+    static void formatRecord(std::string& out, const std::string& type, const std::string& payload);
+
+public:
+    explicit Journal(const std::string& _path);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    const std::string& getPath() const { return path; }
+    std::string getArchivePath() const { return path + ".old"; }
+    // Записи и байты, поставленные в очередь после последней ротации
+    size_t getRecordCount() const { return recordCount; }
+    size_t getByteCount() const { return byteCount; }
+
+    // Ставит запись в очередь без ожидания; на диск она попадет со следующей группой
+    void append(const std::string& type, const std::string& payload);
+
+    // Ставит записи в очередь; future готов, когда группа с ними сброшена на диск,
+    // и бросает std::runtime_error из get(), если записать группу не удалось
+    std::future<void> appendDurable(const std::string& type, const std::string& payload);
+    std::future<void> appendBatchDurable(const std::string& type, const std::vector<std::string>& payloads);
+
+    // Дожидается записи на диск всего, что уже стоит в очереди
+    void sync();
+
+    // Записи, поставленные до вызова, попадут в архивный файл, последующие — в новый журнал.
+    // Возвращается сразу; future готов, когда архив записан и закрыт
+    std::future<void> rotate();
+
+    static uint32_t checksum(std::string_view data);
+
+    static size_t replay(const std::string& path,
+        const std::function<void(std::string_view, std::string_view)>& apply);
+
+    // Атомарно заменяет файл снимка: запись во временный файл, сброс на диск, переименование
+    static bool writeSnapshot(const std::string& path, const std::string& data);
+    static bool writeSnapshot(const std::string& path, const std::vector<std::string>& lines);
+};
+#endif
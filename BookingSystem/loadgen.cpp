@@ -0,0 +1,199 @@
+#include "loadgen.h"
+#include "poller.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <string_view>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const char* const SEARCH_TERMS[] = { "Рок", "Джаз", "Гамлет", "театр" };
+
+    enum class RequestKind { EVENT, SEARCH, STATS, BOOK, CANCEL };
+
+    struct InFlight {
+        RequestKind kind;
+        Clock::time_point start;
+    };
+
+    struct ConnectionResult {
+        bool connected = false;
+        long long errors = 0;
+        long long booked = 0;
+        std::vector<double> latencies;
+    };
+
+    std::string nextRequest(const LoadOptions& options, std::mt19937& random, RequestKind& kind) {
+        int roll = static_cast<int>(random() % 100);
+        int eventId = 1 + static_cast<int>(random() % options.eventCount);
+        if (roll < 50) {
+            kind = RequestKind::EVENT;
+            return "EVENT\t" + std::to_string(eventId) + "\n";
+        }
+        else if (roll < 70) {
+            kind = RequestKind::SEARCH;
+            return std::string("SEARCH\t") + SEARCH_TERMS[random() % std::size(SEARCH_TERMS)] + "\n";
+        }
+        else if (roll < 80) {
+            kind = RequestKind::STATS;
+            return "STATS\n";
+        }
+        kind = RequestKind::BOOK;
+        return "BOOK\t" + std::to_string(eventId) + "\t" + std::to_string(options.userId) + "\n";
+    }
+
+    bool sendAll(SocketHandle socket, const std::string& data) {
+        size_t offset = 0;
+        while (offset < data.size()) {
+            int sent = send(socket, data.data() + offset, static_cast<int>(data.size() - offset), 0);
+            if (sent <= 0) {
+                return false;
+            }
+            offset += sent;
+        }
+        return true;
+    }
+
+    void runConnection(const LoadOptions& options, unsigned seed, ConnectionResult& result) {
+        SocketHandle socket = net::connectTcp(options.host, options.port);
+        if (socket == INVALID_SOCKET_HANDLE) {
+            return;
+        }
+        result.connected = true;
+        result.latencies.reserve(options.requestsPerConnection);
+
+        std::mt19937 random(seed);
+        std::deque<InFlight> inFlight;
+        std::deque<std::string> cancels;
+        std::string input;
+        int issued = 0;
+        char buffer[16 * 1024];
+
+        // Купленные билеты отменяются, чтобы места не кончались; отмены идут сверх requestsPerConnection
+        while (issued < options.requestsPerConnection || !cancels.empty() || !inFlight.empty()) {
+            std::string batch;
+            while (static_cast<int>(inFlight.size()) < options.pipeline &&
+                (issued < options.requestsPerConnection || !cancels.empty())) {
+                RequestKind kind;
+                if (!cancels.empty()) {
+                    kind = RequestKind::CANCEL;
+                    batch += "CANCEL\t" + cancels.front() + "\n";
+                    cancels.pop_front();
+                }
+                else {
+                    batch += nextRequest(options, random, kind);
+                    issued++;
+                }
+                inFlight.push_back(InFlight{ kind, Clock::now() });
+            }
+            if (!batch.empty() && !sendAll(socket, batch)) {
+                break;
+            }
+
+            int received = recv(socket, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                break;
+            }
+            input.append(buffer, received);
+
+            size_t begin = 0;
+            size_t end;
+            while ((end = input.find('\n', begin)) != std::string::npos && !inFlight.empty()) {
+                Clock::time_point now = Clock::now();
+                InFlight request = inFlight.front();
+                inFlight.pop_front();
+                result.latencies.push_back(
+                    std::chrono::duration<double, std::micro>(now - request.start).count());
+
+                std::string_view line(input.data() + begin, end - begin);
+                if (line.compare(0, 2, "OK") != 0) {
+                    // Отказ в бронировании при распроданном событии — не ошибка
+                    if (request.kind != RequestKind::BOOK) {
+                        result.errors++;
+                    }
+                }
+                else if (request.kind == RequestKind::BOOK && line.size() > 3) {
+                    cancels.emplace_back(line.substr(3));
+                    result.booked++;
+                }
+                begin = end + 1;
+            }
+            input.erase(0, begin);
+        }
+
+        // Если сервер закрыл соединение или связь оборвалась, запросы без ответа и так и
+        // не отправленные (включая отмены) считаются ошибками; при полном прогоне их нет
+        result.errors += static_cast<long long>(inFlight.size() + cancels.size()) +
+            (options.requestsPerConnection - issued);
+
+        net::closeSocket(socket);
+    }
+
+    double percentile(const std::vector<double>& sorted, double fraction) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+}
+
+bool runLoadGenerator(const LoadOptions& options) {
+    // При pipeline <= 0 соединение ни разу не отправило бы запрос и ждало бы ответа вечно
+    if (options.connections <= 0 || options.requestsPerConnection <= 0 ||
+        options.pipeline <= 0 || options.eventCount <= 0) {
+        std::cout << "Ошибка: число соединений, запросов, конвейер и число событий должны быть положительными\n";
+        return false;
+    }
+
+    std::vector<ConnectionResult> results(options.connections);
+    std::vector<std::thread> threads;
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < options.connections; i++) {
+        threads.emplace_back(runConnection, std::cref(options), static_cast<unsigned>(i + 1), std::ref(results[i]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> latencies;
+    long long errors = 0;
+    long long booked = 0;
+    int connected = 0;
+    for (const auto& result : results) {
+        connected += result.connected ? 1 : 0;
+        errors += result.errors;
+        booked += result.booked;
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+    }
+    if (connected == 0) {
+        std::cout << "Не удалось подключиться к " << options.host << ":" << options.port << "\n";
+        return false;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "\n================ НАГРУЗОЧНЫЙ ТЕСТ ================\n";
+    std::cout << "Соединений: " << connected << " из " << options.connections
+        << ", конвейер: " << options.pipeline << "\n";
+    std::cout << "Выполнено запросов: " << latencies.size() << " за " << seconds << " с\n";
+    std::cout << "Куплено и отменено билетов: " << booked << "\n";
+    std::cout << "Ошибок: " << errors << "\n";
+    std::cout << "Пропускная способность: " << (seconds > 0 ? latencies.size() / seconds : 0.0) << " запросов/с\n";
+    std::cout << "Задержка, мкс: p50 " << percentile(latencies, 0.50)
+        << ", p90 " << percentile(latencies, 0.90)
+        << ", p99 " << percentile(latencies, 0.99)
+        << ", p99.9 " << percentile(latencies, 0.999)
+        << ", max " << (latencies.empty() ? 0.0 : latencies.back()) << "\n";
+    std::cout << "==================================================\n";
+    return true;
+}
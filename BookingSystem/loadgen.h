@@ -0,0 +1,22 @@
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+#include <string>
+
+struct LoadOptions {
+    std::string host = "127.0.0.1";
+    int port = 7070;
+    int connections = 8;
+    int requestsPerConnection = 20000;
+    // Сколько запросов одно соединение держит в работе, не дожидаясь ответов
+    int pipeline = 16;
+    // Запросы обращаются к событиям с номерами 1..eventCount от имени пользователя userId
+    int eventCount = 4;
+    int userId = 1;
+};
+
+// Генератор нагрузки для BookingServer: смесь просмотров, поиска, статистики и бронирований
+// (каждый купленный билет затем отменяется). Печатает пропускную способность и перцентили задержки.
+// Возвращает false при неположительных параметрах или если не удалось подключиться
+bool runLoadGenerator(const LoadOptions& options);
+#endif
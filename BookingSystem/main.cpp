@@ -2,11 +2,16 @@
 #include <fstream>
 #include <string>
 #include <limits>
+#include <cstdlib>
+#include <thread>
 #include "bookingsystem.h"
 #include "event.h"
 #include "user.h"
 #include "ticket.h"
 #include "datetime.h"
+#include "clock.h"
+#include "server.h"
+#include "loadgen.h"
 
 void clearInputBuffer() {
     std::cin.clear();
@@ -18,7 +23,7 @@ void displaySystemInfo() {
     std::cout << "           СИСТЕМА БРОНИРОВАНИЯ БИЛЕТОВ                 \n";
     std::cout << "=========================================================\n";
     std::cout << "Версия: 1.0\n";
-    std::cout << "Дата: " << DateTime::now().toDateString() << "\n";
+    std::cout << "Дата: " << Clock::now().toDateString() << "\n";
     std::cout << "=========================================================\n\n";
 }
 
@@ -31,10 +36,24 @@ void displayStatistics(const BookingSystem& system) {
     std::cout << "=======================================================\n\n";
 }
 
+template <typename Results>
+void displaySearchResults(const Results& results) {
+    if (results.empty()) {
+        std::cout << "Не найдено событий по вашему запросу.\n";
+    }
+    else {
+        std::cout << "Найдено " << results.size() << " событий:\n";
+        std::cout << "========================================\n";
+        for (const auto& event : results) {
+            event->display();
+            std::cout << "----------------------------------------\n";
+        }
+    }
+}
+
 void searchEvents(BookingSystem& system) {
     int choice = 0;
     std::string searchQuery;
-    std::vector<std::shared_ptr<Event>> results;
 
     std::cout << "\n================== ПОИСК СОБЫТИЙ ==================\n";
     std::cout << "1. Поиск по названию\n";
@@ -45,6 +64,7 @@ void searchEvents(BookingSystem& system) {
     std::cout << "6. Сортировка по дате (от поздней к ранней)\n";
     std::cout << "7. Сортировка по цене (от низкой к высокой)\n";
     std::cout << "8. Сортировка по цене (от высокой к низкой)\n";
+    std::cout << "9. Поиск по названию, месту, исполнителю или режиссеру\n";
     std::cout << "0. Вернуться в главное меню\n";
     std::cout << "Выберите опцию: ";
     std::cin >> choice;
@@ -53,53 +73,46 @@ void searchEvents(BookingSystem& system) {
         return;
     }
 
-    if (choice >= 1 && choice <= 3) {
+    if ((choice >= 1 && choice <= 3) || choice == 9) {
         clearInputBuffer();
         std::cout << "Введите запрос для поиска: ";
         std::getline(std::cin, searchQuery);
     }
 
+    // Выборки по дате и цене держат неизменяемую версию индекса: записи не копируются,
+    // а обход идет уже без блокировки данных
     switch (choice) {
     case 1:
-        results = system.findEventsByName(searchQuery);
+        displaySearchResults(system.findEventsByName(searchQuery));
         break;
     case 2:
-        results = system.findEventsByCategory(searchQuery);
+        displaySearchResults(system.findEventsByCategory(searchQuery));
         break;
     case 3:
-        results = system.findEventsByDate(searchQuery);
+        displaySearchResults(system.findEventsByDate(searchQuery));
         break;
     case 4:
-        results = system.getUpcomingEvents();
+        displaySearchResults(system.getUpcomingEvents());
         break;
     case 5:
-        results = system.getEventsSortedByDate(true);
+        displaySearchResults(system.getEventsSortedByDate(true));
         break;
     case 6:
-        results = system.getEventsSortedByDate(false);
+        displaySearchResults(system.getEventsSortedByDate(false));
         break;
     case 7:
-        results = system.getEventsSortedByPrice(true);
+        displaySearchResults(system.getEventsSortedByPrice(true));
         break;
     case 8:
-        results = system.getEventsSortedByPrice(false);
+        displaySearchResults(system.getEventsSortedByPrice(false));
+        break;
+    case 9:
+        displaySearchResults(system.findEventsByText(searchQuery));
         break;
     default:
         std::cout << "Неверный выбор!\n";
         return;
     }
-
-    if (results.empty()) {
-        std::cout << "Не найдено событий по вашему запросу.\n";
-    }
-    else {
-        std::cout << "Найдено " << results.size() << " событий:\n";
-        std::cout << "========================================\n";
-        for (const auto& event : results) {
-            event->display();
-            std::cout << "----------------------------------------\n";
-        }
-    }
 }
 
 void manageUserTickets(BookingSystem& system) {
@@ -114,21 +127,26 @@ void manageUserTickets(BookingSystem& system) {
         return;
     }
 
-    auto tickets = system.getTicketsByUser(userId);
-    if (tickets.empty()) {
-        std::cout << "У пользователя " << user->getName() << " нет билетов.\n";
-        return;
-    }
-
-    std::cout << "Билеты пользователя " << user->getName() << ":\n";
-    std::cout << "============================================\n";
-    for (const auto& ticket : tickets) {
-        ticket->display();
-        auto event = system.findEventById(ticket->getEventId());
+    // Билеты выводятся прямо из индекса, без копии списка; обращаться к system внутри обхода нельзя
+    bool hasTickets = false;
+    system.forEachTicketOfUser(userId, [&](const Ticket& ticket, const Event* event) {
+        if (!hasTickets) {
+            std::cout << "Билеты пользователя " << user->getName() << ":\n";
+            std::cout << "============================================\n";
+            hasTickets = true;
+        }
+        ticket.display();
         if (event) {
             std::cout << "Событие: " << event->getName() << " (" << event->getDate() << ")\n";
+            if (ticket.getSeatId() != Ticket::NO_SEAT && event->getSeatMap()) {
+                std::cout << "Место: " << event->getSeatMap()->describe(ticket.getSeatId()) << "\n";
+            }
         }
         std::cout << "--------------------------------------------\n";
+    });
+    if (!hasTickets) {
+        std::cout << "У пользователя " << user->getName() << " нет билетов.\n";
+        return;
     }
 
     std::cout << "Хотите отменить бронирование? (1 - Да, 0 - Нет): ";
@@ -171,12 +189,14 @@ void editEvent(BookingSystem& system) {
     std::cout << "4. Базовую цену\n";
     std::cout << "5. Описание\n";
     std::cout << "6. Категорию\n";
+    std::cout << "7. Схему зала\n";
     std::cout << "0. Отмена\n";
     std::cout << "Выберите опцию: ";
     std::cin >> choice;
 
     std::string strValue;
     double doubleValue;
+    BookingSystem::EventUpdate update;
 
     switch (choice) {
     case 0:
@@ -185,42 +205,53 @@ void editEvent(BookingSystem& system) {
         clearInputBuffer();
         std::cout << "Введите новое название: ";
         std::getline(std::cin, strValue);
-        event->setName(strValue);
+        update.name = strValue;
         break;
     case 2:
         std::cout << "Введите новую дату (ГГГГ-ММ-ДД): ";
         std::cin >> strValue;
-        event->setDate(strValue);
+        update.date = strValue;
         break;
     case 3:
         clearInputBuffer();
         std::cout << "Введите новое место проведения: ";
         std::getline(std::cin, strValue);
-        event->setVenue(strValue);
+        update.venue = strValue;
         break;
     case 4:
         std::cout << "Введите новую базовую цену: ";
         std::cin >> doubleValue;
-        event->setBasePrice(doubleValue);
+        update.basePrice = doubleValue;
         break;
     case 5:
         clearInputBuffer();
         std::cout << "Введите новое описание: ";
         std::getline(std::cin, strValue);
-        event->setDescription(strValue);
+        update.description = strValue;
         break;
     case 6:
         clearInputBuffer();
         std::cout << "Введите новую категорию: ";
         std::getline(std::cin, strValue);
-        event->setCategory(strValue);
+        update.category = strValue;
+        break;
+    case 7:
+        clearInputBuffer();
+        std::cout << "Введите схему зала (Сектор:мест в ряду,...;...), пустая строка — без нумерации: ";
+        std::getline(std::cin, strValue);
+        if (!system.setSeatLayout(event, strValue)) {
+            return;
+        }
         break;
     default:
         std::cout << "Неверный выбор!\n";
         return;
     }
 
-    event->saveToFile();
+    // Схема зала задается отдельно, остальные поля — одним изменением с переиндексацией
+    if (choice != 7) {
+        system.updateEvent(event, update);
+    }
     std::cout << "Информация о событии успешно обновлена.\n";
 }
 
@@ -375,6 +406,12 @@ void showMenu(BookingSystem& system) {
                 }
                 else {
                     std::cout << "Не удалось забронировать билет!\n";
+                    std::cout << "Встать в лист ожидания? (1 - Да, 0 - Нет): ";
+                    int wait = 0;
+                    std::cin >> wait;
+                    if (wait == 1 && system.joinWaitlist(event, user) != 0) {
+                        std::cout << "Вы в листе ожидания. Билет будет оформлен, когда освободится место.\n";
+                    }
                 }
             }
             else {
@@ -400,14 +437,57 @@ void showMenu(BookingSystem& system) {
     } while (choice != 0);
 }
 
-int main() {
+void runServer(BookingSystem& system, int port) {
+    BookingServer server(system);
+    if (!net::startup() || !server.listen("127.0.0.1", port)) {
+        std::cout << "Не удалось открыть порт " << port << ".\n";
+        return;
+    }
+
+    std::cout << "Сервер слушает 127.0.0.1:" << port << ". Для остановки нажмите Enter.\n";
+    std::thread console([&server]() {
+        // Без консоли (ввод закрыт) сервер работает до завершения процесса
+        std::string line;
+        if (std::getline(std::cin, line)) {
+            server.stop();
+        }
+    });
+    server.run();
+    console.join();
+}
+
+// Режимы запуска:
+//   BookingSystem                                                   — консольное меню
+//   BookingSystem --server [порт]                                   — сетевой сервер
+//   BookingSystem --loadgen [порт] [соединений] [запросов] [конвейер] — нагрузка на сервер
+int main(int argc, char* argv[]) {
+    std::string mode = (argc > 1) ? argv[1] : "";
+    if (mode == "--loadgen") {
+        LoadOptions options;
+        if (argc > 2) {
+            options.port = std::atoi(argv[2]);
+        }
+        if (argc > 3) {
+            options.connections = std::atoi(argv[3]);
+        }
+        if (argc > 4) {
+            options.requestsPerConnection = std::atoi(argv[4]);
+        }
+        if (argc > 5) {
+            options.pipeline = std::atoi(argv[5]);
+        }
+        return (net::startup() && runLoadGenerator(options)) ? 0 : 1;
+    }
+
     BookingSystem& system = BookingSystem::getInstance();
 
     displaySystemInfo();
 
     std::ifstream test_file("events.txt");
-    bool files_exist = test_file.good();
+    std::ifstream journal_file("journal.txt");
+    bool files_exist = test_file.good() || journal_file.peek() != std::ifstream::traits_type::eof();
     test_file.close();
+    journal_file.close();
 
     if (files_exist) {
         std::cout << "Обнаружены существующие данные. Загружаем данные из файлов...\n";
@@ -445,7 +525,12 @@ int main() {
         user2->bookTicket(play2);
     }
 
-    showMenu(system);
+    if (mode == "--server") {
+        runServer(system, (argc > 2) ? std::atoi(argv[2]) : LoadOptions().port);
+    }
+    else {
+        showMenu(system);
+    }
 
     BookingSystem::destroy();
 
@@ -0,0 +1,255 @@
+#include "poller.h"
+#include <cstring>
+
+#ifdef _WIN32
+#ifdef _MSC_VER
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+#else
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+    const int LISTEN_BACKLOG = 512;
+    const int MAX_EVENTS = 256;
+
+    bool makeAddress(const std::string& host, int port, sockaddr_in& address) {
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<unsigned short>(port));
+        return inet_pton(AF_INET, host.c_str(), &address.sin_addr) == 1;
+    }
+}
+
+bool net::startup() {
+#ifdef _WIN32
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+    return true;
+#endif
+}
+
+void net::closeSocket(SocketHandle socket) {
+#ifdef _WIN32
+    closesocket(socket);
+#else
+    close(socket);
+#endif
+}
+
+bool net::setNonBlocking(SocketHandle socket) {
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(socket, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+void net::setNoDelay(SocketHandle socket) {
+    int enabled = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enabled), sizeof(enabled));
+}
+
+bool net::wouldBlock() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+SocketHandle net::listenTcp(const std::string& host, int port) {
+    sockaddr_in address;
+    if (!makeAddress(host, port, address)) {
+        return INVALID_SOCKET_HANDLE;
+    }
+
+    SocketHandle socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (socket == INVALID_SOCKET_HANDLE) {
+        return INVALID_SOCKET_HANDLE;
+    }
+
+    int reuse = 1;
+    setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+    if (bind(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(socket, LISTEN_BACKLOG) != 0 || !setNonBlocking(socket)) {
+        closeSocket(socket);
+        return INVALID_SOCKET_HANDLE;
+    }
+    return socket;
+}
+
+SocketHandle net::connectTcp(const std::string& host, int port) {
+    sockaddr_in address;
+    if (!makeAddress(host, port, address)) {
+        return INVALID_SOCKET_HANDLE;
+    }
+
+    SocketHandle socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (socket == INVALID_SOCKET_HANDLE) {
+        return INVALID_SOCKET_HANDLE;
+    }
+
+    if (connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        closeSocket(socket);
+        return INVALID_SOCKET_HANDLE;
+    }
+    setNoDelay(socket);
+    return socket;
+}
+
+bool net::socketPair(SocketHandle& reader, SocketHandle& writer) {
+    // Слушающий сокет на случайном порту loopback нужен только на время соединения
+    SocketHandle listener = listenTcp("127.0.0.1", 0);
+    if (listener == INVALID_SOCKET_HANDLE) {
+        return false;
+    }
+
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length);
+    writer = connectTcp("127.0.0.1", ntohs(address.sin_port));
+
+    reader = INVALID_SOCKET_HANDLE;
+    if (writer != INVALID_SOCKET_HANDLE) {
+        Poller poller;
+        std::vector<PollEvent> events;
+        poller.add(listener);
+        if (poller.wait(1000, events) > 0) {
+            reader = accept(listener, nullptr, nullptr);
+        }
+    }
+    closeSocket(listener);
+
+    if (reader == INVALID_SOCKET_HANDLE) {
+        if (writer != INVALID_SOCKET_HANDLE) {
+            closeSocket(writer);
+        }
+        return false;
+    }
+    return setNonBlocking(reader) && setNonBlocking(writer);
+}
+
+#ifdef _WIN32
+
+Poller::Poller() {
+}
+
+Poller::~Poller() {
+}
+
+bool Poller::add(SocketHandle socket, bool wantRead, bool wantWrite) {
+    WSAPOLLFD fd;
+    fd.fd = socket;
+    fd.events = (wantRead ? POLLRDNORM : 0) | (wantWrite ? POLLWRNORM : 0);
+    fd.revents = 0;
+    positions[socket] = fds.size();
+    fds.push_back(fd);
+    return true;
+}
+
+bool Poller::update(SocketHandle socket, bool wantRead, bool wantWrite) {
+    auto it = positions.find(socket);
+    if (it == positions.end()) {
+        return false;
+    }
+    fds[it->second].events = (wantRead ? POLLRDNORM : 0) | (wantWrite ? POLLWRNORM : 0);
+    return true;
+}
+
+void Poller::remove(SocketHandle socket) {
+    auto it = positions.find(socket);
+    if (it == positions.end()) {
+        return;
+    }
+
+    // Последний элемент переносится на место удаленного
+    size_t position = it->second;
+    positions.erase(it);
+    if (position + 1 != fds.size()) {
+        fds[position] = fds.back();
+        positions[fds[position].fd] = position;
+    }
+    fds.pop_back();
+}
+
+int Poller::wait(int timeoutMs, std::vector<PollEvent>& events) {
+    events.clear();
+    if (fds.empty()) {
+        Sleep(timeoutMs < 0 ? 0 : timeoutMs);
+        return 0;
+    }
+
+    int ready = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeoutMs);
+    if (ready <= 0) {
+        return 0;
+    }
+
+    for (auto& fd : fds) {
+        if (fd.revents != 0) {
+            events.push_back(PollEvent{ fd.fd,
+                (fd.revents & (POLLRDNORM | POLLHUP)) != 0,
+                (fd.revents & POLLWRNORM) != 0,
+                (fd.revents & (POLLERR | POLLNVAL)) != 0 });
+            fd.revents = 0;
+        }
+    }
+    return static_cast<int>(events.size());
+}
+
+#else
+
+namespace {
+    bool control(int epollFd, int operation, SocketHandle socket, bool wantRead, bool wantWrite) {
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = (wantRead ? static_cast<uint32_t>(EPOLLIN) : 0u) | (wantWrite ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        event.data.fd = socket;
+        return epoll_ctl(epollFd, operation, socket, &event) == 0;
+    }
+}
+
+Poller::Poller() : epollFd(epoll_create1(EPOLL_CLOEXEC)) {
+}
+
+Poller::~Poller() {
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+bool Poller::add(SocketHandle socket, bool wantRead, bool wantWrite) {
+    return control(epollFd, EPOLL_CTL_ADD, socket, wantRead, wantWrite);
+}
+
+bool Poller::update(SocketHandle socket, bool wantRead, bool wantWrite) {
+    return control(epollFd, EPOLL_CTL_MOD, socket, wantRead, wantWrite);
+}
+
+void Poller::remove(SocketHandle socket) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, socket, nullptr);
+}
+
+int Poller::wait(int timeoutMs, std::vector<PollEvent>& events) {
+    events.clear();
+    epoll_event ready[MAX_EVENTS];
+    int count = epoll_wait(epollFd, ready, MAX_EVENTS, timeoutMs);
+    for (int i = 0; i < count; i++) {
+        events.push_back(PollEvent{ ready[i].data.fd,
+            (ready[i].events & (EPOLLIN | EPOLLHUP)) != 0,
+            (ready[i].events & EPOLLOUT) != 0,
+            (ready[i].events & EPOLLERR) != 0 });
+    }
+    return static_cast<int>(events.size());
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef POLLER_H
+#define POLLER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#endif
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+const SocketHandle INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+#else
+using SocketHandle = int;
+const SocketHandle INVALID_SOCKET_HANDLE = -1;
+#endif
+
+// Минимальная переносимая обертка над сокетами для сервера и генератора нагрузки
+namespace net {
+    // Инициализирует сетевую подсистему (WSAStartup в Windows); вызывается один раз до работы с сокетами
+    bool startup();
+
+    void closeSocket(SocketHandle socket);
+    bool setNonBlocking(SocketHandle socket);
+    void setNoDelay(SocketHandle socket);
+    // Последняя операция не выполнена, потому что неблокирующий сокет не готов
+    bool wouldBlock();
+
+    SocketHandle listenTcp(const std::string& host, int port);
+    SocketHandle connectTcp(const std::string& host, int port);
+
+    // Пара соединенных сокетов через loopback — для пробуждения цикла событий из других потоков
+    bool socketPair(SocketHandle& reader, SocketHandle& writer);
+}
+
+struct PollEvent {
+    SocketHandle socket;
+    bool readable;
+    bool writable;
+    bool failed;
+};
+
+// Ожидание готовности сокетов: epoll в Linux, WSAPoll в Windows. Срабатывание по уровню
+class Poller {
+private:
+#ifdef _WIN32
+    std::vector<WSAPOLLFD> fds;
+    std::unordered_map<SocketHandle, size_t> positions;
+#else
+    int epollFd;
+#endif
+
+public:
+    Poller();
+    ~Poller();
+
+    Poller(const Poller&) = delete;
+    Poller& operator=(const Poller&) = delete;
+
+    bool add(SocketHandle socket, bool wantRead = true, bool wantWrite = false);
+    bool update(SocketHandle socket, bool wantRead, bool wantWrite);
+    void remove(SocketHandle socket);
+
+    // Ждет не дольше timeoutMs (-1 — без ограничения) и заполняет events готовыми сокетами
+    int wait(int timeoutMs, std::vector<PollEvent>& events);
+};
+#endif
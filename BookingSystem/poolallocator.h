@@ -0,0 +1,97 @@
+#ifndef POOLALLOCATOR_H
+#define POOLALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <utility>
+
+// Пул блоков одного размера. Память берется пластинами по SLAB_BYTES и нарезается на блоки;
+// освобожденные блоки возвращаются в список свободных и используются повторно.
+template <size_t Size, size_t Align>
+class FixedPool {
+private:
+    static constexpr size_t SLAB_BYTES = 64 * 1024;
+
+    union Block {
+        Block* next;
+        alignas(Align) unsigned char storage[Size];
+    };
+
+    static constexpr size_t BLOCKS_PER_SLAB = (SLAB_BYTES / sizeof(Block) > 16) ? SLAB_BYTES / sizeof(Block) : 16;
+
+    std::mutex mutex;
+    Block* freeList = nullptr;
+    std::vector<std::unique_ptr<Block[]>> slabs;
+
+    void grow() {
+        slabs.emplace_back(new Block[BLOCKS_PER_SLAB]);
+        Block* slab = slabs.back().get();
+        for (size_t i = 0; i < BLOCKS_PER_SLAB; i++) {
+            slab[i].next = freeList;
+            freeList = &slab[i];
+        }
+    }
+
+public:
+    // Пул не разрушается при выходе: объекты могут пережить статические переменные
+    static FixedPool& instance() {
+        static FixedPool* pool = new FixedPool();
+        return *pool;
+    }
+
+    void* allocate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!freeList) {
+            grow();
+        }
+        Block* block = freeList;
+        freeList = block->next;
+        return block;
+    }
+
+    void deallocate(void* pointer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Block* block = static_cast<Block*>(pointer);
+        block->next = freeList;
+        freeList = block;
+    }
+};
+
+// Аллокатор для std::allocate_shared: объект и счетчик ссылок лежат в одном блоке пула
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        if (count != 1) {
+            return std::allocator<T>().allocate(count);
+        }
+        return static_cast<T*>(FixedPool<sizeof(T), alignof(T)>::instance().allocate());
+    }
+
+    void deallocate(T* pointer, size_t count) {
+        if (count != 1) {
+            std::allocator<T>().deallocate(pointer, count);
+            return;
+        }
+        FixedPool<sizeof(T), alignof(T)>::instance().deallocate(pointer);
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const { return false; }
+};
+
+template <typename T, typename... Args>
+std::shared_ptr<T> makePooled(Args&&... args) {
+    return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
+#endif
@@ -0,0 +1,80 @@
+#include "prefixindex.h"
+#include "textindex.h"
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+    bool isWordChar(char32_t c) {
+        if (c < 0x80) {
+            return (c >= U'0' && c <= U'9') || (c >= U'a' && c <= U'z');
+        }
+        return c >= 0xC0 && !(c >= 0x2000 && c <= 0x206F);
+    }
+}
+
+void PrefixIndex::collectEntries(int id, const std::vector<std::string>& fields, std::vector<Entry>& out) {
+    std::u32string text;
+    for (const auto& field : fields) {
+        if (!text.empty()) {
+            text += U'\0';
+        }
+        text += TextIndex::normalize(field);
+    }
+
+    const std::u32string& stored = texts[id] = std::move(text);
+    size_t fieldEnd = 0;
+    for (size_t i = 0; i < stored.size(); i++) {
+        if (i >= fieldEnd) {
+            fieldEnd = stored.find(U'\0', i);
+            if (fieldEnd == std::u32string::npos) {
+                fieldEnd = stored.size();
+            }
+        }
+        if (isWordChar(stored[i]) && (i == 0 || !isWordChar(stored[i - 1]))) {
+            out.push_back(Entry{ stored.data() + i, static_cast<uint32_t>(fieldEnd - i), id });
+        }
+    }
+}
+
+void PrefixIndex::add(int id, const std::vector<std::string>& fields) {
+    remove(id);
+
+    std::vector<Entry> added;
+    collectEntries(id, fields, added);
+    for (const auto& entry : added) {
+        entries.insert(std::upper_bound(entries.begin(), entries.end(), entry, less), entry);
+    }
+}
+
+void PrefixIndex::remove(int id) {
+    auto text = texts.find(id);
+    if (text == texts.end()) {
+        return;
+    }
+
+    // Одинаковые ключи одного документа различаются адресом слова
+    const char32_t* begin = text->second.data();
+    const char32_t* end = begin + text->second.size();
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+        [id, begin, end](const Entry& entry) {
+            return entry.id == id && entry.word >= begin && entry.word < end;
+        }), entries.end());
+    texts.erase(text);
+}
+
+std::vector<int> PrefixIndex::find(std::string_view prefix, size_t limit) const {
+    std::u32string normalized = TextIndex::normalize(prefix);
+    std::vector<int> result;
+    std::unordered_set<int> seen;
+
+    auto it = std::lower_bound(entries.begin(), entries.end(), normalized,
+        [](const Entry& entry, const std::u32string& key) { return entry.key() < key; });
+
+    for (; it != entries.end() && result.size() < limit &&
+        it->key().compare(0, normalized.size(), normalized) == 0; ++it) {
+        if (seen.insert(it->id).second) {
+            result.push_back(it->id);
+        }
+    }
+    return result;
+}
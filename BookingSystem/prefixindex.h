@@ -0,0 +1,60 @@
+#ifndef PREFIXINDEX_H
+#define PREFIXINDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+
+// Отсортированный массив начал слов для подсказок при вводе.
+// Ключом служит остаток поля, начиная с каждого слова, поэтому «фест»
+// находит «Рок-фестиваль». Нормализованный текст хранится один раз на документ,
+// а запись массива — только смещение слова в нем. Поиск по префиксу — двоичный
+// поиск и обход совпадений до набора нужного числа документов.
+class PrefixIndex {
+private:
+    struct Entry {
+        const char32_t* word;
+        uint32_t length;
+        int id;
+
+        std::u32string_view key() const { return std::u32string_view(word, length); }
+    };
+
+    static bool less(const Entry& a, const Entry& b) {
+        int order = a.key().compare(b.key());
+        return order < 0 || (order == 0 && a.id < b.id);
+    }
+
+    // Нормализованные поля документа через U'\0'. Записи указывают внутрь строки,
+    // поэтому она не меняется, пока документ есть в индексе (узлы unordered_map не переезжают)
+    std::unordered_map<int, std::u32string> texts;
+    std::vector<Entry> entries;
+
+    // Сохраняет текст документа и добавляет в out записи его слов без сортировки
+    void collectEntries(int id, const std::vector<std::string>& fields, std::vector<Entry>& out);
+
+public:
+    // Добавляет или заменяет документ
+    void add(int id, const std::vector<std::string>& fields);
+    void remove(int id);
+
+    template <typename Container, typename FieldsOf>
+    void rebuild(const Container& items, FieldsOf fieldsOf) {
+        texts.clear();
+        entries.clear();
+        for (const auto& item : items) {
+            collectEntries(item->getId(), fieldsOf(*item), entries);
+        }
+        std::sort(entries.begin(), entries.end(), less);
+    }
+
+    // Не более limit ID без повторов, у которых одно из слов начинается с prefix,
+    // в порядке ключей: сначала ближайшие по алфавиту дополнения. Без limit — все совпадения
+    std::vector<int> find(std::string_view prefix, size_t limit = SIZE_MAX) const;
+
+    size_t size() const { return entries.size(); }
+};
+#endif
@@ -0,0 +1,77 @@
+#include "recordreader.h"
+#include <charconv>
+
+RecordReader::RecordReader(std::string_view _record) : record(_record), pos(0), exhausted(false) {}
+
+bool RecordReader::next(std::string_view& field) {
+    if (exhausted) {
+        return false;
+    }
+
+    size_t tab = record.find('\t', pos);
+    if (tab == std::string_view::npos) {
+        field = record.substr(pos);
+        exhausted = true;
+    }
+    else {
+        field = record.substr(pos, tab - pos);
+        pos = tab + 1;
+    }
+    return true;
+}
+
+bool RecordReader::next(std::string& field) {
+    std::string_view view;
+    if (!next(view)) {
+        return false;
+    }
+    field.assign(view.data(), view.size());
+    return true;
+}
+
+bool RecordReader::next(int& value) {
+    std::string_view view;
+    if (!next(view)) {
+        return false;
+    }
+
+    const char* end = view.data() + view.size();
+    auto result = std::from_chars(view.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+bool RecordReader::next(double& value) {
+    std::string_view view;
+    if (!next(view)) {
+        return false;
+    }
+
+    const char* end = view.data() + view.size();
+    auto result = std::from_chars(view.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+bool RecordReader::skip() {
+    std::string_view ignored;
+    return next(ignored);
+}
+
+LineReader::LineReader(std::string_view _buffer) : buffer(_buffer), pos(0) {}
+
+bool LineReader::next(std::string_view& line) {
+    if (pos >= buffer.size()) {
+        return false;
+    }
+
+    size_t end = buffer.find('\n', pos);
+    if (end == std::string_view::npos) {
+        end = buffer.size();
+    }
+
+    line = buffer.substr(pos, end - pos);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    pos = end + 1;
+    return true;
+}
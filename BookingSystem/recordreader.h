@@ -0,0 +1,37 @@
+#ifndef RECORDREADER_H
+#define RECORDREADER_H
+
+#include <string>
+#include <string_view>
+
+// Разбор записи с полями через табуляцию без выделения памяти:
+// поля возвращаются как string_view, числа читаются через std::from_chars
+class RecordReader {
+private:
+    std::string_view record;
+    size_t pos;
+    bool exhausted;
+
+public:
+    explicit RecordReader(std::string_view _record);
+
+    bool next(std::string_view& field);
+    bool next(std::string& field);
+    bool next(int& value);
+    bool next(double& value);
+
+    bool skip();
+};
+
+// Построчное чтение буфера; завершающий '\r' отбрасывается
+class LineReader {
+private:
+    std::string_view buffer;
+    size_t pos;
+
+public:
+    explicit LineReader(std::string_view _buffer);
+
+    bool next(std::string_view& line);
+};
+#endif
@@ -0,0 +1,77 @@
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+// Хранилище объектов с порядком добавления и поиском по ID за O(1)
+template <typename T>
+class Registry {
+private:
+    std::vector<std::shared_ptr<T>> items;
+    std::unordered_map<int, size_t> index;
+
+public:
+    static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+    using const_iterator = typename std::vector<std::shared_ptr<T>>::const_iterator;
+
+    // Добавляет объект; объект с тем же ID заменяется на своем месте
+    void add(std::shared_ptr<T> item) {
+        auto it = index.find(item->getId());
+        if (it != index.end()) {
+            items[it->second] = std::move(item);
+            return;
+        }
+
+        index.emplace(item->getId(), items.size());
+        items.push_back(std::move(item));
+    }
+
+    std::shared_ptr<T> find(int id) const {
+        auto it = index.find(id);
+        return (it != index.end()) ? items[it->second] : nullptr;
+    }
+
+    bool contains(int id) const { return index.count(id) > 0; }
+
+    // Удаляет объект, перенося на его место последний; возвращает освободившуюся позицию
+    // (NO_SLOT, если объекта нет), чтобы параллельные таблицы повторили перестановку
+    size_t remove(int id) {
+        auto it = index.find(id);
+        if (it == index.end()) {
+            return NO_SLOT;
+        }
+
+        size_t slot = it->second;
+        index.erase(it);
+        if (slot + 1 != items.size()) {
+            items[slot] = std::move(items.back());
+            index[items[slot]->getId()] = slot;
+        }
+        items.pop_back();
+        return slot;
+    }
+
+    // Позиция объекта в порядке добавления; меняется, только если на ее место перенесен объект при remove
+    size_t slotOf(int id) const {
+        auto it = index.find(id);
+        return (it != index.end()) ? it->second : NO_SLOT;
+    }
+
+    const std::shared_ptr<T>& at(size_t slot) const { return items[slot]; }
+
+    void reserve(size_t count) {
+        items.reserve(count);
+        index.reserve(count);
+    }
+
+    const std::vector<std::shared_ptr<T>>& all() const { return items; }
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+
+    const_iterator begin() const { return items.begin(); }
+    const_iterator end() const { return items.end(); }
+};
+#endif
@@ -0,0 +1,78 @@
+#include "salesrollup.h"
+
+void SalesRollup::add(std::map<int64_t, Totals>& buckets, int64_t key, const Totals& delta, int sign) {
+    Totals& totals = buckets[key];
+    totals.bookings += sign * delta.bookings;
+    totals.cancellations += sign * delta.cancellations;
+    totals.bookedAmount += sign * delta.bookedAmount;
+    totals.canceledAmount += sign * delta.canceledAmount;
+
+    if (totals.bookings == 0 && totals.cancellations == 0) {
+        buckets.erase(key);
+    }
+}
+
+void SalesRollup::addBooking(const DateTime& time, double price, int sign) {
+    if (!time.isValid()) {
+        return;
+    }
+
+    Totals delta;
+    delta.bookings = 1;
+    delta.bookedAmount = price;
+    add(hourly, time.getHour(), delta, sign);
+    add(daily, time.getDay(), delta, sign);
+}
+
+void SalesRollup::addCancellation(const DateTime& time, double price, int sign) {
+    if (!time.isValid()) {
+        return;
+    }
+
+    Totals delta;
+    delta.cancellations = 1;
+    delta.canceledAmount = price;
+    add(hourly, time.getHour(), delta, sign);
+    add(daily, time.getDay(), delta, sign);
+}
+
+void SalesRollup::merge(const SalesRollup& other, int sign) {
+    for (const auto& bucket : other.hourly) {
+        add(hourly, bucket.first, bucket.second, sign);
+    }
+    for (const auto& bucket : other.daily) {
+        add(daily, bucket.first, bucket.second, sign);
+    }
+}
+
+void SalesRollup::clear() {
+    hourly.clear();
+    daily.clear();
+}
+
+std::vector<RollupBucket> SalesRollup::query(const DateTime& from, const DateTime& to, RollupPeriod period) const {
+    const auto& buckets = (period == RollupPeriod::HOUR) ? hourly : daily;
+    int64_t length = (period == RollupPeriod::HOUR) ? DateTime::SECONDS_PER_HOUR : DateTime::SECONDS_PER_DAY;
+
+    std::vector<RollupBucket> result;
+    if (!from.isValid() || !to.isValid()) {
+        return result;
+    }
+
+    int64_t first = (period == RollupPeriod::HOUR) ? from.getHour() : from.getDay();
+    int64_t last = (period == RollupPeriod::HOUR) ? to.getHour() : to.getDay();
+    if (last * length < to.toSeconds()) {
+        last++;
+    }
+
+    for (auto it = buckets.lower_bound(first); it != buckets.end() && it->first < last; ++it) {
+        RollupBucket bucket;
+        bucket.start = DateTime::fromSeconds(it->first * length);
+        bucket.bookings = it->second.bookings;
+        bucket.cancellations = it->second.cancellations;
+        bucket.bookedAmount = it->second.bookedAmount;
+        bucket.canceledAmount = it->second.canceledAmount;
+        result.push_back(bucket);
+    }
+    return result;
+}
@@ -0,0 +1,50 @@
+#ifndef SALESROLLUP_H
+#define SALESROLLUP_H
+
+#include <map>
+#include <vector>
+#include <cstdint>
+#include "datetime.h"
+
+// Итоги продаж за один интервал времени
+struct RollupBucket {
+    DateTime start;
+    int bookings = 0;
+    int cancellations = 0;
+    double bookedAmount = 0.0;
+    double canceledAmount = 0.0;
+
+    double getNetSales() const { return bookedAmount - canceledAmount; }
+};
+
+enum class RollupPeriod { HOUR, DAY };
+
+// Продажи и отмены, разложенные по часам и дням. Интервалы хранятся в упорядоченных
+// картах, поэтому выборка за период — O(log n + k) без обращения к самим билетам.
+class SalesRollup {
+private:
+    struct Totals {
+        int bookings = 0;
+        int cancellations = 0;
+        double bookedAmount = 0.0;
+        double canceledAmount = 0.0;
+    };
+
+    std::map<int64_t, Totals> hourly;
+    std::map<int64_t, Totals> daily;
+
+    static void add(std::map<int64_t, Totals>& buckets, int64_t key, const Totals& delta, int sign);
+
+public:
+    // sign = -1 снимает ранее учтенное бронирование или отмену
+    void addBooking(const DateTime& time, double price, int sign = 1);
+    void addCancellation(const DateTime& time, double price, int sign = 1);
+
+    // Прибавляет (sign = 1) или вычитает (sign = -1) другой набор итогов
+    void merge(const SalesRollup& other, int sign = 1);
+    void clear();
+
+    // Непустые интервалы, пересекающиеся с [from, to), по возрастанию времени
+    std::vector<RollupBucket> query(const DateTime& from, const DateTime& to, RollupPeriod period) const;
+};
+#endif
@@ -0,0 +1,58 @@
+#include "salesstats.h"
+#include <cmath>
+
+void CompensatedSum::add(double value) {
+    double total = sum + value;
+    if (std::fabs(sum) >= std::fabs(value)) {
+        compensation += (sum - total) + value;
+    }
+    else {
+        compensation += (value - total) + sum;
+    }
+    sum = total;
+}
+
+void SalesStats::book(double price) {
+    activeCount++;
+    activeSales.add(price);
+    allPrices.add(price);
+}
+
+void SalesStats::cancel(double price) {
+    activeCount--;
+    canceledCount++;
+    activeSales.add(-price);
+}
+
+void SalesStats::restore(double price) {
+    canceledCount--;
+    activeCount++;
+    activeSales.add(price);
+}
+
+void SalesStats::unbook(double price) {
+    activeCount--;
+    activeSales.add(-price);
+    allPrices.add(-price);
+}
+
+SalesStats& SalesStats::operator+=(const SalesStats& other) {
+    activeCount += other.activeCount;
+    canceledCount += other.canceledCount;
+    activeSales.add(other.activeSales.value());
+    allPrices.add(other.allPrices.value());
+    return *this;
+}
+
+SalesStats& SalesStats::operator-=(const SalesStats& other) {
+    activeCount -= other.activeCount;
+    canceledCount -= other.canceledCount;
+    activeSales.add(-other.activeSales.value());
+    allPrices.add(-other.allPrices.value());
+    return *this;
+}
+
+double SalesStats::getAverageTicketPrice() const {
+    int count = getTicketsCount();
+    return (count > 0) ? allPrices.value() / count : 0.0;
+}
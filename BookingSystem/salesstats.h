@@ -0,0 +1,41 @@
+#ifndef SALESSTATS_H
+#define SALESSTATS_H
+
+// Сумма с компенсацией ошибки округления (алгоритм Ноймайера):
+// при миллионах слагаемых результат не «уплывает», как у простого накопления
+class CompensatedSum {
+private:
+    double sum = 0.0;
+    double compensation = 0.0;
+
+public:
+    void add(double value);
+    double value() const { return sum + compensation; }
+};
+
+// Накопительная статистика продаж, обновляемая при каждом бронировании и отмене
+class SalesStats {
+private:
+    int activeCount = 0;
+    int canceledCount = 0;
+    CompensatedSum activeSales;
+    CompensatedSum allPrices;
+
+public:
+    void book(double price);
+    void cancel(double price);
+    void restore(double price);
+    // Снимает бронирование, учтенное book, — как будто его не было
+    void unbook(double price);
+
+    SalesStats& operator+=(const SalesStats& other);
+    SalesStats& operator-=(const SalesStats& other);
+
+    int getActiveCount() const { return activeCount; }
+    int getCanceledCount() const { return canceledCount; }
+    int getTicketsCount() const { return activeCount + canceledCount; }
+    double getTotalSales() const { return activeSales.value(); }
+    // Средняя цена по всем билетам, включая отмененные
+    double getAverageTicketPrice() const;
+};
+#endif
@@ -0,0 +1,204 @@
+#include "seatmap.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <string_view>
+
+namespace {
+    std::string_view trim(std::string_view text) {
+        size_t begin = text.find_first_not_of(' ');
+        if (begin == std::string_view::npos) {
+            return std::string_view();
+        }
+        size_t end = text.find_last_not_of(' ');
+        return text.substr(begin, end - begin + 1);
+    }
+}
+
+SeatMap::SeatMap() : seatCount(0), freeCount(0) {
+}
+
+std::unique_ptr<SeatMap> SeatMap::parse(const std::string& layout) {
+    auto map = std::make_unique<SeatMap>();
+    size_t nextBit = 0;
+
+    std::string_view rest(layout);
+    while (!rest.empty()) {
+        size_t partEnd = rest.find(';');
+        std::string_view part = rest.substr(0, partEnd);
+        rest = (partEnd == std::string_view::npos) ? std::string_view() : rest.substr(partEnd + 1);
+
+        size_t colon = part.find(':');
+        if (colon == std::string_view::npos) {
+            return nullptr;
+        }
+        std::string_view name = trim(part.substr(0, colon));
+        if (name.empty() || name.find_first_of("\t\n,") != std::string_view::npos) {
+            return nullptr;
+        }
+
+        int section = static_cast<int>(map->sections.size());
+        map->sections.emplace_back(name);
+
+        std::string_view rowList = part.substr(colon + 1);
+        int number = 1;
+        while (!rowList.empty()) {
+            size_t comma = rowList.find(',');
+            std::string_view field = trim(rowList.substr(0, comma));
+            rowList = (comma == std::string_view::npos) ? std::string_view() : rowList.substr(comma + 1);
+
+            int seats = 0;
+            auto parsed = std::from_chars(field.data(), field.data() + field.size(), seats);
+            if (parsed.ec != std::errc() || parsed.ptr != field.data() + field.size() || seats <= 0) {
+                return nullptr;
+            }
+
+            map->rows.push_back(Row{ section, number++, map->seatCount, seats, nextBit });
+            for (int i = 0; i < seats; i++) {
+                map->freeSeats.set(nextBit + i);
+            }
+            nextBit += (static_cast<size_t>(seats) + 63) / 64 * 64;
+            map->seatCount += seats;
+        }
+    }
+
+    if (map->seatCount == 0) {
+        return nullptr;
+    }
+    map->freeCount = map->seatCount;
+    return map;
+}
+
+std::string SeatMap::getLayout() const {
+    std::string layout;
+    int section = -1;
+    for (const auto& row : rows) {
+        if (row.section != section) {
+            if (section >= 0) {
+                layout += ';';
+            }
+            section = row.section;
+            layout += sections[section];
+            layout += ':';
+        }
+        else {
+            layout += ',';
+        }
+        layout += std::to_string(row.seats);
+    }
+    return layout;
+}
+
+const SeatMap::Row* SeatMap::rowOf(int seat) const {
+    if (seat < 0 || seat >= seatCount) {
+        return nullptr;
+    }
+
+    auto it = std::upper_bound(rows.begin(), rows.end(), seat,
+        [](int s, const Row& row) { return s < row.firstSeat; });
+    return &*(it - 1);
+}
+
+size_t SeatMap::bitOf(int seat) const {
+    const Row* row = rowOf(seat);
+    return row->firstBit + (seat - row->firstSeat);
+}
+
+bool SeatMap::isFree(int seat) const {
+    return rowOf(seat) && freeSeats.test(bitOf(seat));
+}
+
+bool SeatMap::take(int seat) {
+    if (!isFree(seat)) {
+        return false;
+    }
+
+    freeSeats.reset(bitOf(seat));
+    freeCount--;
+    return true;
+}
+
+bool SeatMap::release(int seat) {
+    if (!rowOf(seat) || isFree(seat)) {
+        return false;
+    }
+
+    freeSeats.set(bitOf(seat));
+    freeCount++;
+    return true;
+}
+
+std::vector<int> SeatMap::findBestAvailable(int count) const {
+    std::vector<int> result;
+    if (count <= 0 || count > freeCount) {
+        return result;
+    }
+
+    for (const auto& row : rows) {
+        if (row.seats < count) {
+            continue;
+        }
+
+        // Обходим отрезки свободных мест ряда; из подходящих выбираем ближайший к центру
+        size_t end = row.firstBit + row.seats;
+        size_t center2 = row.firstBit * 2 + row.seats;
+        size_t bestStart = end;
+        size_t bestDistance = 0;
+        for (size_t pos = freeSeats.nextSet(row.firstBit, end); pos < end; ) {
+            size_t runEnd = freeSeats.nextClear(pos, end);
+            if (runEnd - pos >= static_cast<size_t>(count)) {
+                // Сдвигаем блок к центру ряда, не выходя за границы отрезка
+                size_t ideal = (center2 > static_cast<size_t>(count)) ? (center2 - count) / 2 : 0;
+                size_t start = std::min(std::max(ideal, pos), runEnd - count);
+                size_t distance = static_cast<size_t>(std::llabs(
+                    static_cast<long long>(start * 2 + count) - static_cast<long long>(center2)));
+                if (bestStart == end || distance < bestDistance) {
+                    bestStart = start;
+                    bestDistance = distance;
+                }
+            }
+            pos = freeSeats.nextSet(runEnd, end);
+        }
+
+        if (bestStart != end) {
+            int first = row.firstSeat + static_cast<int>(bestStart - row.firstBit);
+            for (int i = 0; i < count; i++) {
+                result.push_back(first + i);
+            }
+            return result;
+        }
+    }
+
+    return result;
+}
+
+std::vector<int> SeatMap::allocate(int count) {
+    std::vector<int> result = findBestAvailable(count);
+    if (result.empty() && count > 0 && count <= freeCount) {
+        for (const auto& row : rows) {
+            size_t end = row.firstBit + row.seats;
+            for (size_t pos = freeSeats.nextSet(row.firstBit, end);
+                pos < end && static_cast<int>(result.size()) < count; pos = freeSeats.nextSet(pos + 1, end)) {
+                result.push_back(row.firstSeat + static_cast<int>(pos - row.firstBit));
+            }
+            if (static_cast<int>(result.size()) == count) {
+                break;
+            }
+        }
+    }
+
+    for (int seat : result) {
+        take(seat);
+    }
+    return result;
+}
+
+std::string SeatMap::describe(int seat) const {
+    const Row* row = rowOf(seat);
+    if (!row) {
+        return "место " + std::to_string(seat);
+    }
+
+    return sections[row->section] + ", ряд " + std::to_string(row->number) +
+        ", место " + std::to_string(seat - row->firstSeat + 1);
+}
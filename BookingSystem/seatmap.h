@@ -0,0 +1,56 @@
+#ifndef SEATMAP_H
+#define SEATMAP_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "bitmap.h"
+
+// Схема зала: секторы, ряды и места. Место обозначается сквозным номером по схеме.
+// Свободные места — установленные биты; каждый ряд начинается с нового 64-битного слова,
+// поэтому поиск подряд идущих мест в ряду идет по словам, а не по отдельным местам.
+class SeatMap {
+private:
+    struct Row {
+        int section;
+        int number;
+        int firstSeat;
+        int seats;
+        size_t firstBit;
+    };
+
+    std::vector<std::string> sections;
+    std::vector<Row> rows;
+    Bitmap freeSeats;
+    int seatCount;
+    int freeCount;
+
+    const Row* rowOf(int seat) const;
+    size_t bitOf(int seat) const;
+
+public:
+    SeatMap();
+
+    // Разбирает схему вида "Партер:20,20,22;Балкон:15,15" (сектор: число мест в каждом ряду);
+    // при ошибке возвращает nullptr
+    static std::unique_ptr<SeatMap> parse(const std::string& layout);
+
+    std::string getLayout() const;
+    int getSeatCount() const { return seatCount; }
+    int getFreeCount() const { return freeCount; }
+
+    bool isFree(int seat) const;
+    bool take(int seat);
+    bool release(int seat);
+
+    // count соседних свободных мест в ближайшем к сцене ряду, как можно ближе к центру ряда;
+    // пустой результат, если ни в одном ряду нет столько мест подряд
+    std::vector<int> findBestAvailable(int count) const;
+
+    // Занимает count мест: рядом, если возможно, иначе первые свободные по схеме
+    std::vector<int> allocate(int count);
+
+    // "Партер, ряд 3, место 5"
+    std::string describe(int seat) const;
+};
+#endif
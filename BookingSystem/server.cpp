@@ -0,0 +1,366 @@
+#include "server.h"
+#include "bookingsystem.h"
+#include "recordreader.h"
+#include <sstream>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#endif
+
+namespace {
+    const size_t READ_CHUNK = 16 * 1024;
+    const int POLL_TIMEOUT_MS = 1000;
+
+    std::string error(const std::string& message) {
+        return "ERR\t" + message;
+    }
+
+    std::string describeTickets(const std::vector<std::shared_ptr<Ticket>>& tickets) {
+        std::string reply = "OK";
+        for (const auto& ticket : tickets) {
+            reply += '\t';
+            reply += std::to_string(ticket->getId());
+        }
+        return reply;
+    }
+
+    int sendSome(SocketHandle socket, const char* data, size_t size) {
+#ifdef _WIN32
+        return send(socket, data, static_cast<int>(size), 0);
+#else
+        return static_cast<int>(send(socket, data, size, MSG_NOSIGNAL));
+#endif
+    }
+}
+
+BookingServer::BookingServer(BookingSystem& _system, size_t workerCount)
+    : system(_system), listener(INVALID_SOCKET_HANDLE), wakeReader(INVALID_SOCKET_HANDLE),
+    wakeWriter(INVALID_SOCKET_HANDLE), nextConnectionId(1), stopping(false), workers(workerCount) {
+}
+
+BookingServer::~BookingServer() {
+    workers.shutdown();
+
+    for (auto& connection : connections) {
+        net::closeSocket(connection.second.socket);
+    }
+    for (SocketHandle socket : { listener, wakeReader, wakeWriter }) {
+        if (socket != INVALID_SOCKET_HANDLE) {
+            net::closeSocket(socket);
+        }
+    }
+}
+
+bool BookingServer::listen(const std::string& host, int port) {
+    listener = net::listenTcp(host, port);
+    if (listener == INVALID_SOCKET_HANDLE || !net::socketPair(wakeReader, wakeWriter)) {
+        return false;
+    }
+
+    return poller.add(listener) && poller.add(wakeReader);
+}
+
+void BookingServer::run() {
+    std::vector<PollEvent> events;
+    while (!stopping) {
+        poller.wait(POLL_TIMEOUT_MS, events);
+        for (const auto& event : events) {
+            if (event.socket == listener) {
+                acceptConnections();
+                continue;
+            }
+            if (event.socket == wakeReader) {
+                char buffer[256];
+                while (recv(wakeReader, buffer, sizeof(buffer), 0) > 0) {
+                }
+                collectCompletions();
+                continue;
+            }
+
+            auto it = connectionIds.find(event.socket);
+            if (it == connectionIds.end()) {
+                continue;
+            }
+            uint64_t id = it->second;
+            if (event.failed) {
+                closeConnection(id);
+                continue;
+            }
+            if (event.readable) {
+                readFrom(id, connections[id]);
+            }
+            auto connection = connections.find(id);
+            if (event.writable && connection != connections.end()) {
+                writeTo(id, connection->second);
+                resumeReading(id, connection->second);
+            }
+        }
+    }
+}
+
+void BookingServer::stop() {
+    stopping = true;
+    wake();
+}
+
+void BookingServer::wake() {
+    char signal = 1;
+    sendSome(wakeWriter, &signal, 1);
+}
+
+void BookingServer::acceptConnections() {
+    for (;;) {
+        SocketHandle socket = accept(listener, nullptr, nullptr);
+        if (socket == INVALID_SOCKET_HANDLE) {
+            return;
+        }
+
+        net::setNonBlocking(socket);
+        net::setNoDelay(socket);
+        uint64_t id = nextConnectionId++;
+        Connection& connection = connections[id];
+        connection.socket = socket;
+        connectionIds[socket] = id;
+        poller.add(socket);
+    }
+}
+
+void BookingServer::readFrom(uint64_t id, Connection& connection) {
+    char buffer[READ_CHUNK];
+    for (;;) {
+        // Разбираем все полные строки; при переполнении конвейера или вывода остальное ждет в буфере
+        size_t begin = 0;
+        size_t end;
+        while (!mustPauseReading(connection) &&
+            (end = connection.input.find('\n', begin)) != std::string::npos) {
+            size_t length = end - begin;
+            if (length > 0 && connection.input[end - 1] == '\r') {
+                length--;
+            }
+            dispatch(id, connection, connection.input.substr(begin, length));
+            begin = end + 1;
+        }
+        connection.input.erase(0, begin);
+
+        connection.readPaused = mustPauseReading(connection);
+        if (connection.readPaused) {
+            break;
+        }
+        if (connection.input.size() > MAX_LINE_LENGTH) {
+            closeConnection(id);
+            return;
+        }
+
+        int received = recv(connection.socket, buffer, sizeof(buffer), 0);
+        if (received == 0 || (received < 0 && !net::wouldBlock())) {
+            closeConnection(id);
+            return;
+        }
+        if (received < 0) {
+            break;
+        }
+        connection.input.append(buffer, received);
+    }
+    updateInterest(connection);
+}
+
+void BookingServer::dispatch(uint64_t id, Connection& connection, std::string line) {
+    uint64_t sequence = connection.firstSequence + connection.replies.size();
+    connection.replies.emplace_back();
+
+    workers.submit([this, id, sequence, line = std::move(line)]() {
+        std::string text = execute(system, line);
+        bool wasEmpty;
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            wasEmpty = completions.empty();
+            completions.push_back(Completion{ id, sequence, std::move(text) });
+        }
+        // Цикл событий забирает все готовые ответы разом, поэтому будим его один раз
+        if (wasEmpty) {
+            wake();
+        }
+    });
+}
+
+void BookingServer::collectCompletions() {
+    std::vector<Completion> ready;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        ready.swap(completions);
+    }
+
+    std::vector<uint64_t> touched;
+    for (auto& completion : ready) {
+        auto it = connections.find(completion.connectionId);
+        if (it == connections.end()) {
+            continue;
+        }
+
+        Reply& reply = it->second.replies[completion.sequence - it->second.firstSequence];
+        reply.ready = true;
+        reply.text = std::move(completion.text);
+        touched.push_back(completion.connectionId);
+    }
+
+    for (uint64_t id : touched) {
+        auto it = connections.find(id);
+        if (it == connections.end()) {
+            continue;
+        }
+
+        Connection& connection = it->second;
+        flushReplies(connection);
+        writeTo(id, connection);
+        resumeReading(id, connection);
+    }
+}
+
+bool BookingServer::mustPauseReading(const Connection& connection) {
+    return connection.replies.size() >= MAX_PIPELINE || pendingOutput(connection) > MAX_PENDING_OUTPUT;
+}
+
+void BookingServer::resumeReading(uint64_t id, Connection& connection) {
+    // writeTo мог закрыть соединение; вывод должен опуститься до нижней границы, чтобы
+    // медленный клиент не переключал чтение на каждом отправленном фрагменте
+    if (!connections.count(id) || !connection.readPaused ||
+        connection.replies.size() >= MAX_PIPELINE || pendingOutput(connection) > RESUME_OUTPUT) {
+        return;
+    }
+    connection.readPaused = false;
+    readFrom(id, connection);
+}
+
+void BookingServer::flushReplies(Connection& connection) {
+    while (!connection.replies.empty() && connection.replies.front().ready) {
+        connection.output += connection.replies.front().text;
+        connection.output += '\n';
+        connection.replies.pop_front();
+        connection.firstSequence++;
+    }
+}
+
+void BookingServer::writeTo(uint64_t id, Connection& connection) {
+    while (connection.outputOffset < connection.output.size()) {
+        int sent = sendSome(connection.socket, connection.output.data() + connection.outputOffset,
+            connection.output.size() - connection.outputOffset);
+        if (sent < 0) {
+            if (!net::wouldBlock()) {
+                closeConnection(id);
+                return;
+            }
+            break;
+        }
+        connection.outputOffset += sent;
+    }
+
+    if (connection.outputOffset == connection.output.size()) {
+        connection.output.clear();
+        connection.outputOffset = 0;
+    }
+    updateInterest(connection);
+}
+
+void BookingServer::updateInterest(Connection& connection) {
+    bool wantRead = !connection.readPaused;
+    bool wantWrite = !connection.output.empty();
+    if (wantRead != connection.readWanted || wantWrite != connection.writeWanted) {
+        poller.update(connection.socket, wantRead, wantWrite);
+        connection.readWanted = wantRead;
+        connection.writeWanted = wantWrite;
+    }
+}
+
+void BookingServer::closeConnection(uint64_t id) {
+    auto it = connections.find(id);
+    if (it == connections.end()) {
+        return;
+    }
+
+    // Незавершенные запросы выполнятся, но их ответы будут отброшены
+    poller.remove(it->second.socket);
+    net::closeSocket(it->second.socket);
+    connectionIds.erase(it->second.socket);
+    connections.erase(it);
+}
+
+std::string BookingServer::execute(BookingSystem& system, std::string_view request) {
+    RecordReader reader(request);
+    std::string_view command;
+    reader.next(command);
+
+    if (command == "PING") {
+        return "OK";
+    }
+    else if (command == "BOOK") {
+        // Количество необязательно, но если оно передано, то должно быть положительным числом
+        int eventId, userId, count = 1;
+        std::string_view countText;
+        if (!(reader.next(eventId) && reader.next(userId)) ||
+            (reader.next(countText) && !RecordReader(countText).next(count)) || count <= 0) {
+            return error("формат: BOOK eventId userId [count > 0]");
+        }
+
+        auto event = system.findEventById(eventId);
+        auto user = system.findUserById(userId);
+        if (!event || !user) {
+            return error("событие или пользователь не найдены");
+        }
+
+        std::vector<std::shared_ptr<Ticket>> tickets;
+        if (count == 1) {
+            if (auto ticket = system.createTicket(event, user)) {
+                tickets.push_back(ticket);
+            }
+        }
+        else {
+            tickets = system.createTickets(event, user, count);
+        }
+        return tickets.empty() ? error("нет свободных мест") : describeTickets(tickets);
+    }
+    else if (command == "CANCEL") {
+        int ticketId;
+        if (!reader.next(ticketId)) {
+            return error("формат: CANCEL ticketId");
+        }
+        return system.cancelTicket(ticketId) ? "OK" : error("билет не найден или уже отменен");
+    }
+    else if (command == "EVENT") {
+        int eventId;
+        if (!reader.next(eventId)) {
+            return error("формат: EVENT eventId");
+        }
+        std::string record = system.describeEvent(eventId);
+        return record.empty() ? error("событие не найдено") : "OK\t" + record;
+    }
+    else if (command == "TICKET") {
+        int ticketId;
+        if (!reader.next(ticketId)) {
+            return error("формат: TICKET ticketId");
+        }
+        std::string record = system.describeTicket(ticketId);
+        return record.empty() ? error("билет не найден") : "OK\t" + record;
+    }
+    else if (command == "SEARCH") {
+        std::string text;
+        if (!reader.next(text) || text.empty()) {
+            return error("формат: SEARCH текст");
+        }
+        auto events = system.findEventsByText(text);
+        std::string reply = "OK\t" + std::to_string(events.size());
+        for (const auto& event : events) {
+            reply += '\t';
+            reply += std::to_string(event->getId());
+        }
+        return reply;
+    }
+    else if (command == "STATS") {
+        SalesStats stats = system.getSalesStats();
+        std::ostringstream reply;
+        reply << "OK\t" << stats.getActiveCount() << "\t" << stats.getCanceledCount() << "\t"
+            << stats.getTotalSales() << "\t" << stats.getAverageTicketPrice();
+        return reply.str();
+    }
+
+    return error("неизвестная команда");
+}
@@ -0,0 +1,116 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "poller.h"
+#include "threadpool.h"
+
+class BookingSystem;
+
+// Сетевой интерфейс к BookingSystem: один поток с циклом событий на неблокирующих сокетах
+// и фиксированный пул потоков для выполнения запросов.
+//
+// Протокол строковый: запрос — строка "КОМАНДА\tаргумент\t...\n", ответ — строка "OK\t...\n"
+// или "ERR\tсообщение\n". Клиент может отправлять запросы, не дожидаясь ответов;
+// запросы одного соединения выполняются параллельно, ответы приходят в порядке запросов.
+//
+//   PING                                  -> OK
+//   BOOK  eventId userId [count]          -> OK ticketId...
+//   CANCEL ticketId                       -> OK
+//   EVENT eventId                         -> OK тип запись события
+//   TICKET ticketId                       -> OK запись билета
+//   SEARCH текст                          -> OK число eventId...
+//   STATS                                 -> OK активных отмененных сумма средняя_цена
+class BookingServer {
+private:
+    // Ответ на один запрос; до выполнения запроса ready = false
+    struct Reply {
+        bool ready = false;
+        std::string text;
+    };
+
+    struct Connection {
+        SocketHandle socket;
+        std::string input;
+        std::string output;
+        size_t outputOffset = 0;
+        // Ответы в порядке запросов; номер первого — firstSequence
+        std::deque<Reply> replies;
+        uint64_t firstSequence = 0;
+        bool readPaused = false;
+        // Интерес, зарегистрированный в poller
+        bool readWanted = true;
+        bool writeWanted = false;
+    };
+
+    struct Completion {
+        uint64_t connectionId;
+        uint64_t sequence;
+        std::string text;
+    };
+
+    static const size_t MAX_LINE_LENGTH = 64 * 1024;
+    // Не больше стольких запросов одного соединения в работе; дальше чтение приостанавливается
+    static const size_t MAX_PIPELINE = 128;
+    // Чтение приостанавливается и тогда, когда клиент не забирает ответы: неотправленного вывода
+    // больше MAX_PENDING_OUTPUT. Возобновляется, когда его становится не больше RESUME_OUTPUT
+    static const size_t MAX_PENDING_OUTPUT = 1024 * 1024;
+    static const size_t RESUME_OUTPUT = 256 * 1024;
+
+    BookingSystem& system;
+    Poller poller;
+    SocketHandle listener;
+    SocketHandle wakeReader;
+    SocketHandle wakeWriter;
+    std::unordered_map<uint64_t, Connection> connections;
+    std::unordered_map<SocketHandle, uint64_t> connectionIds;
+    uint64_t nextConnectionId;
+    std::atomic<bool> stopping;
+
+    std::mutex completionMutex;
+    std::vector<Completion> completions;
+
+    // Задачи пишут в completions и будят цикл через wakeWriter, поэтому деструктор
+    // останавливает пул раньше, чем закрывает сокеты
+    ThreadPool workers;
+
+    void acceptConnections();
+    void readFrom(uint64_t id, Connection& connection);
+    void writeTo(uint64_t id, Connection& connection);
+    void dispatch(uint64_t id, Connection& connection, std::string line);
+    void collectCompletions();
+    void flushReplies(Connection& connection);
+    static size_t pendingOutput(const Connection& connection) { return connection.output.size() - connection.outputOffset; }
+    static bool mustPauseReading(const Connection& connection);
+    // Снимает паузу чтения, если конвейер и вывод разгрузились, и разбирает накопленные запросы
+    void resumeReading(uint64_t id, Connection& connection);
+    void updateInterest(Connection& connection);
+    void closeConnection(uint64_t id);
+    void wake();
+
+public:
+    explicit BookingServer(BookingSystem& _system, size_t workerCount = std::thread::hardware_concurrency());
+    ~BookingServer();
+
+    BookingServer(const BookingServer&) = delete;
+    BookingServer& operator=(const BookingServer&) = delete;
+
+    bool listen(const std::string& host, int port);
+
+    // Цикл событий; возвращается после stop()
+    void run();
+    // Можно вызывать из любого потока
+    void stop();
+
+    // Выполняет одну строку запроса и возвращает строку ответа без перевода строки
+    static std::string execute(BookingSystem& system, std::string_view request);
+};
+#endif
@@ -0,0 +1,211 @@
+#include "snapshot.h"
+#include "user.h"
+#include "event.h"
+#include "ticket.h"
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+snapshot::StrRef SnapshotWriter::addString(const std::string& value) {
+    snapshot::StrRef ref{ static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size()) };
+    strings += value;
+    return ref;
+}
+
+void SnapshotWriter::addUser(const User& user) {
+    snapshot::UserRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.id = user.getId();
+    record.name = addString(user.getName());
+    record.email = addString(user.getEmail());
+    record.phone = addString(user.getPhone());
+    users.push_back(record);
+}
+
+void SnapshotWriter::addEvent(const Event& event) {
+    snapshot::EventRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.id = event.getId();
+    record.basePrice = event.getBasePrice();
+    record.totalSeats = event.getTotalSeats();
+    record.availableSeats = event.getAvailableSeats();
+    record.name = addString(event.getName());
+    record.date = event.getEventDate().toSeconds();
+    record.venue = addString(event.getVenue());
+    record.description = addString(event.getDescription());
+    record.category = addString(event.getCategory());
+    record.seatLayout = addString(event.getSeatLayout());
+
+    if (auto concert = dynamic_cast<const Concert*>(&event)) {
+        record.kind = snapshot::KIND_CONCERT;
+        record.person = addString(concert->getArtist());
+        record.genre = addString(concert->getGenre());
+        record.duration = concert->getDuration();
+    }
+    else if (auto play = dynamic_cast<const TheatrePlay*>(&event)) {
+        record.kind = snapshot::KIND_THEATRE_PLAY;
+        record.person = addString(play->getDirector());
+        record.genre = addString(play->getGenre());
+        record.duration = play->getDuration();
+        record.ageLimit = play->getAgeLimit();
+    }
+    else {
+        return;
+    }
+
+    events.push_back(record);
+}
+
+void SnapshotWriter::addTicket(const Ticket& ticket) {
+    snapshot::TicketRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.id = ticket.getId();
+    record.eventId = ticket.getEventId();
+    record.userId = ticket.getUserId();
+    record.price = ticket.getPrice();
+    record.isActive = ticket.getIsActive() ? 1 : 0;
+    record.seatId = ticket.getSeatId();
+    record.bookingTime = ticket.getBookingDateTime().toSeconds();
+    record.cancelTime = ticket.getCancelDateTime().toSeconds();
+    tickets.push_back(record);
+}
+
+std::string SnapshotWriter::serialize() const {
+    snapshot::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, snapshot::MAGIC, sizeof(header.magic));
+    header.version = snapshot::VERSION;
+    header.userCount = users.size();
+    header.eventCount = events.size();
+    header.ticketCount = tickets.size();
+    header.stringsSize = strings.size();
+
+    std::string out;
+    out.reserve(sizeof(header) + users.size() * sizeof(snapshot::UserRecord) +
+        events.size() * sizeof(snapshot::EventRecord) +
+        tickets.size() * sizeof(snapshot::TicketRecord) + strings.size());
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(reinterpret_cast<const char*>(users.data()), users.size() * sizeof(snapshot::UserRecord));
+    out.append(reinterpret_cast<const char*>(events.data()), events.size() * sizeof(snapshot::EventRecord));
+    out.append(reinterpret_cast<const char*>(tickets.data()), tickets.size() * sizeof(snapshot::TicketRecord));
+    out += strings;
+    return out;
+}
+
+SnapshotReader::SnapshotReader() : data(nullptr), size(0), header(nullptr) {}
+
+SnapshotReader::~SnapshotReader() {
+    unmap();
+}
+
+void SnapshotReader::unmap() {
+    if (data) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+#else
+        munmap(const_cast<char*>(data), size);
+#endif
+    }
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+}
+
+bool SnapshotReader::open(const std::string& path) {
+    unmap();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(snapshot::Header))) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        return false;
+    }
+
+    data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(mapping);
+    if (!data) {
+        return false;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(snapshot::Header))) {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    data = static_cast<const char*>(mapped);
+    size = static_cast<size_t>(st.st_size);
+#endif
+
+    const auto* candidate = reinterpret_cast<const snapshot::Header*>(data);
+    uint64_t expected = sizeof(snapshot::Header) +
+        candidate->userCount * sizeof(snapshot::UserRecord) +
+        candidate->eventCount * sizeof(snapshot::EventRecord) +
+        candidate->ticketCount * sizeof(snapshot::TicketRecord) +
+        candidate->stringsSize;
+
+    if (std::memcmp(candidate->magic, snapshot::MAGIC, sizeof(candidate->magic)) != 0 ||
+        candidate->version != snapshot::VERSION || expected != size) {
+        unmap();
+        return false;
+    }
+
+    header = candidate;
+    return true;
+}
+
+const snapshot::UserRecord* SnapshotReader::getUsers() const {
+    return reinterpret_cast<const snapshot::UserRecord*>(data + sizeof(snapshot::Header));
+}
+
+const snapshot::EventRecord* SnapshotReader::getEvents() const {
+    return reinterpret_cast<const snapshot::EventRecord*>(getUsers() + getUserCount());
+}
+
+const snapshot::TicketRecord* SnapshotReader::getTickets() const {
+    return reinterpret_cast<const snapshot::TicketRecord*>(getEvents() + getEventCount());
+}
+
+std::string SnapshotReader::getString(const snapshot::StrRef& ref) const {
+    return std::string(getStringView(ref));
+}
+
+std::string_view SnapshotReader::getStringView(const snapshot::StrRef& ref) const {
+    const char* strings = reinterpret_cast<const char*>(getTickets() + getTicketCount());
+    if (static_cast<uint64_t>(ref.offset) + ref.length > header->stringsSize) {
+        return std::string_view();
+    }
+    return std::string_view(strings + ref.offset, ref.length);
+}
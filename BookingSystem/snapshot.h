@@ -0,0 +1,130 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+class User;
+class Event;
+class Ticket;
+
+// Двоичный снимок: заголовок, массивы записей фиксированной длины
+// (пользователи, события, билеты) и общая таблица строк. Даты хранятся секундами DateTime.
+namespace snapshot {
+    const char MAGIC[4] = { 'B', 'K', 'S', 'N' };
+    const uint32_t VERSION = 4;
+
+    enum EventKind : int32_t {
+        KIND_CONCERT = 0,
+        KIND_THEATRE_PLAY = 1
+    };
+
+    struct StrRef {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t userCount;
+        uint64_t eventCount;
+        uint64_t ticketCount;
+        uint64_t stringsSize;
+    };
+
+    struct UserRecord {
+        int32_t id;
+        int32_t reserved;
+        StrRef name;
+        StrRef email;
+        StrRef phone;
+    };
+
+    struct EventRecord {
+        double basePrice;
+        int64_t date;
+        int32_t id;
+        int32_t kind;
+        int32_t totalSeats;
+        int32_t availableSeats;
+        int32_t duration;
+        int32_t ageLimit;
+        StrRef name;
+        StrRef venue;
+        StrRef person;
+        StrRef genre;
+        StrRef description;
+        StrRef category;
+        StrRef seatLayout;
+    };
+
+    struct TicketRecord {
+        double price;
+        int64_t bookingTime;
+        // Для действующего билета — недействительное время
+        int64_t cancelTime;
+        int32_t id;
+        int32_t eventId;
+        int32_t userId;
+        int32_t isActive;
+        int32_t seatId;
+        int32_t reserved;
+    };
+
+    static_assert(sizeof(Header) % 8 == 0, "snapshot header must keep 8-byte alignment");
+    static_assert(sizeof(UserRecord) % 8 == 0, "snapshot records must keep 8-byte alignment");
+    static_assert(sizeof(EventRecord) % 8 == 0, "snapshot records must keep 8-byte alignment");
+    static_assert(sizeof(TicketRecord) % 8 == 0, "snapshot records must keep 8-byte alignment");
+}
+
+class SnapshotWriter {
+private:
+    std::vector<snapshot::UserRecord> users;
+    std::vector<snapshot::EventRecord> events;
+    std::vector<snapshot::TicketRecord> tickets;
+    std::string strings;
+
+    snapshot::StrRef addString(const std::string& value);
+
+public:
+    void addUser(const User& user);
+    void addEvent(const Event& event);
+    void addTicket(const Ticket& ticket);
+
+    std::string serialize() const;
+};
+
+// Снимок, отображенный в память; записи читаются напрямую из файла
+class SnapshotReader {
+private:
+    const char* data;
+    size_t size;
+    const snapshot::Header* header;
+
+    void unmap();
+
+public:
+    SnapshotReader();
+    ~SnapshotReader();
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    bool open(const std::string& path);
+
+    size_t getUserCount() const { return header ? static_cast<size_t>(header->userCount) : 0; }
+    size_t getEventCount() const { return header ? static_cast<size_t>(header->eventCount) : 0; }
+    size_t getTicketCount() const { return header ? static_cast<size_t>(header->ticketCount) : 0; }
+
+    const snapshot::UserRecord* getUsers() const;
+    const snapshot::EventRecord* getEvents() const;
+    const snapshot::TicketRecord* getTickets() const;
+
+    std::string getString(const snapshot::StrRef& ref) const;
+    // Без копирования; действительна, пока файл открыт
+    std::string_view getStringView(const snapshot::StrRef& ref) const;
+};
+#endif
@@ -0,0 +1,224 @@
+#ifndef SORTEDINDEX_H
+#define SORTEDINDEX_H
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+
+// Упорядоченный индекс по паре (ключ, ID) на отсортированном векторе.
+// Вектор неизменяем: изменение индекса собирает новый и подменяет указатель на него
+// (индексы событий меняются редко, а читаются постоянно). Диапазон держит свою версию
+// вектора, поэтому создается за O(1) без копирования записей и остается действительным
+// после изменений индекса и снятия блокировки. Поиск границ — O(log n), обход — O(k).
+template <typename Key, typename T>
+class SortedIndex {
+public:
+    struct Entry {
+        Key key;
+        int id;
+        std::shared_ptr<T> value;
+    };
+
+    // Позиция в индексе для постраничного обхода: ключ и ID последней выданной записи
+    struct Cursor {
+        Key key;
+        int id;
+    };
+
+    class Iterator {
+    private:
+        const Entry* base;
+        ptrdiff_t pos;
+        ptrdiff_t step;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::shared_ptr<T>;
+        using difference_type = ptrdiff_t;
+        using pointer = const std::shared_ptr<T>*;
+        using reference = const std::shared_ptr<T>&;
+
+        Iterator() : base(nullptr), pos(0), step(1) {}
+        Iterator(const Entry* _base, ptrdiff_t _pos, ptrdiff_t _step) : base(_base), pos(_pos), step(_step) {}
+
+        reference operator*() const { return base[pos].value; }
+        pointer operator->() const { return &base[pos].value; }
+        const Key& key() const { return base[pos].key; }
+
+        Iterator& operator++() {
+            pos += step;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator copy = *this;
+            pos += step;
+            return copy;
+        }
+
+        bool operator==(const Iterator& other) const { return pos == other.pos; }
+        bool operator!=(const Iterator& other) const { return pos != other.pos; }
+    };
+
+    // Отрезок [first, last) индекса, обходимый по возрастанию или убыванию ключа
+    class Range {
+    private:
+        // Версия записей индекса, на которой построен диапазон
+        std::shared_ptr<const std::vector<Entry>> storage;
+        const Entry* base;
+        ptrdiff_t first;
+        ptrdiff_t last;
+        bool ascending;
+
+        Range withBounds(ptrdiff_t _first, ptrdiff_t _last, bool _ascending) const {
+            Range range = *this;
+            range.first = _first;
+            range.last = _last;
+            range.ascending = _ascending;
+            return range;
+        }
+
+    public:
+        Range() : base(nullptr), first(0), last(0), ascending(true) {}
+        Range(std::shared_ptr<const std::vector<Entry>> _storage, ptrdiff_t _first, ptrdiff_t _last,
+            bool _ascending = true)
+            : storage(std::move(_storage)), base(storage->data()), first(_first), last(_last), ascending(_ascending) {}
+
+        Iterator begin() const { return ascending ? Iterator(base, first, 1) : Iterator(base, last - 1, -1); }
+        Iterator end() const { return ascending ? Iterator(base, last, 1) : Iterator(base, first - 1, -1); }
+
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+
+        Range reversed() const { return withBounds(first, last, !ascending); }
+
+        // Первые count записей в порядке обхода
+        Range take(size_t count) const {
+            ptrdiff_t n = static_cast<ptrdiff_t>(std::min(count, size()));
+            return ascending ? withBounds(first, first + n, true) : withBounds(last - n, last, false);
+        }
+
+        // Курсор последней записи в порядке обхода; диапазон не должен быть пустым
+        Cursor cursor() const {
+            const Entry& entry = ascending ? base[last - 1] : base[first];
+            return Cursor{ entry.key, entry.id };
+        }
+    };
+
+private:
+    std::shared_ptr<const std::vector<Entry>> entries = std::make_shared<const std::vector<Entry>>();
+
+    static bool less(const Entry& a, const Entry& b) {
+        return a.key < b.key || (!(b.key < a.key) && a.id < b.id);
+    }
+
+    ptrdiff_t lowerBound(const Cursor& cursor) const {
+        Entry probe{ cursor.key, cursor.id, nullptr };
+        return std::lower_bound(entries->begin(), entries->end(), probe, &less) - entries->begin();
+    }
+
+    ptrdiff_t upperBound(const Cursor& cursor) const {
+        Entry probe{ cursor.key, cursor.id, nullptr };
+        return std::upper_bound(entries->begin(), entries->end(), probe, &less) - entries->begin();
+    }
+
+    ptrdiff_t lowerBound(const Key& key) const {
+        auto it = std::lower_bound(entries->begin(), entries->end(), key,
+            [](const Entry& entry, const Key& k) { return entry.key < k; });
+        return it - entries->begin();
+    }
+
+    ptrdiff_t upperBound(const Key& key) const {
+        auto it = std::upper_bound(entries->begin(), entries->end(), key,
+            [](const Key& k, const Entry& entry) { return k < entry.key; });
+        return it - entries->begin();
+    }
+
+    Range makeRange(ptrdiff_t first, ptrdiff_t last, bool ascending = true) const {
+        return Range(entries, first, std::max(first, last), ascending);
+    }
+
+    ptrdiff_t count() const { return static_cast<ptrdiff_t>(entries->size()); }
+
+public:
+    void insert(const Key& key, std::shared_ptr<T> value) {
+        Entry entry{ key, value->getId(), std::move(value) };
+        auto next = std::make_shared<std::vector<Entry>>();
+        next->reserve(entries->size() + 1);
+        auto position = std::upper_bound(entries->begin(), entries->end(), entry, &less);
+        next->insert(next->end(), entries->begin(), position);
+        next->push_back(std::move(entry));
+        next->insert(next->end(), position, entries->end());
+        entries = std::move(next);
+    }
+
+    // Удаляет запись с данным ключом и ID; если ключ уже изменился, запись ищется по ID
+    bool erase(const Key& key, int id) {
+        Entry probe{ key, id, nullptr };
+        auto it = std::lower_bound(entries->begin(), entries->end(), probe, &less);
+        if (it == entries->end() || it->id != id || it->key < key || key < it->key) {
+            it = std::find_if(entries->begin(), entries->end(), [id](const Entry& entry) { return entry.id == id; });
+            if (it == entries->end()) {
+                return false;
+            }
+        }
+
+        auto next = std::make_shared<std::vector<Entry>>();
+        next->reserve(entries->size() - 1);
+        next->insert(next->end(), entries->begin(), it);
+        next->insert(next->end(), std::next(it), entries->end());
+        entries = std::move(next);
+        return true;
+    }
+
+    // Полная перестройка индекса — для начальной загрузки
+    template <typename Container, typename KeyOf>
+    void rebuild(const Container& items, KeyOf keyOf) {
+        auto next = std::make_shared<std::vector<Entry>>();
+        next->reserve(items.size());
+        for (const auto& item : items) {
+            next->push_back(Entry{ keyOf(*item), item->getId(), item });
+        }
+        std::sort(next->begin(), next->end(), &less);
+        entries = std::move(next);
+    }
+
+    void clear() { entries = std::make_shared<const std::vector<Entry>>(); }
+    size_t size() const { return entries->size(); }
+    bool empty() const { return entries->empty(); }
+
+    Range all(bool ascending = true) const {
+        return makeRange(0, count(), ascending);
+    }
+
+    // Записи с ключом в [from, to)
+    Range between(const Key& from, const Key& to, bool ascending = true) const {
+        return makeRange(lowerBound(from), lowerBound(to), ascending);
+    }
+
+    // Записи с ключом в [from, to] включительно
+    Range within(const Key& from, const Key& to, bool ascending = true) const {
+        return makeRange(lowerBound(from), upperBound(to), ascending);
+    }
+
+    // Записи с ключом строго больше key
+    Range after(const Key& key, bool ascending = true) const {
+        return makeRange(upperBound(key), count(), ascending);
+    }
+
+    // Записи с ключом не меньше key
+    Range from(const Key& key, bool ascending = true) const {
+        return makeRange(lowerBound(key), count(), ascending);
+    }
+
+    // До count записей, следующих за курсором в порядке обхода
+    Range page(const Cursor& after, size_t count, bool ascending = true) const {
+        if (ascending) {
+            return makeRange(upperBound(after), this->count(), true).take(count);
+        }
+        return makeRange(0, lowerBound(after), false).take(count);
+    }
+};
+#endif
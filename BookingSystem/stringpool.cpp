@@ -0,0 +1,54 @@
+#include "stringpool.h"
+#include <deque>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+
+namespace {
+    // deque не перемещает элементы при добавлении, поэтому указатели на записи стабильны
+    struct Pool {
+        std::deque<StringPool::Entry> entries;
+        std::unordered_map<std::string_view, const StringPool::Entry*> index;
+        std::shared_mutex mutex;
+    };
+
+    Pool& pool() {
+        static Pool instance;
+        return instance;
+    }
+}
+
+const StringPool::Entry* StringPool::intern(std::string_view text) {
+    Pool& p = pool();
+    {
+        std::shared_lock<std::shared_mutex> lock(p.mutex);
+        auto it = p.index.find(text);
+        if (it != p.index.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(p.mutex);
+    auto it = p.index.find(text);
+    if (it != p.index.end()) {
+        return it->second;
+    }
+
+    p.entries.push_back(Entry{ std::string(text), static_cast<uint32_t>(p.entries.size()) });
+    const Entry* entry = &p.entries.back();
+    p.index.emplace(entry->text, entry);
+    return entry;
+}
+
+const StringPool::Entry* StringPool::find(std::string_view text) {
+    Pool& p = pool();
+    std::shared_lock<std::shared_mutex> lock(p.mutex);
+    auto it = p.index.find(text);
+    return (it != p.index.end()) ? it->second : nullptr;
+}
+
+size_t StringPool::size() {
+    Pool& p = pool();
+    std::shared_lock<std::shared_mutex> lock(p.mutex);
+    return p.entries.size();
+}
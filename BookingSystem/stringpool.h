@@ -0,0 +1,45 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <ostream>
+
+// Словарь часто повторяющихся строк (категории, жанры, места, исполнители).
+// Каждая строка хранится один раз и получает небольшой числовой ID; записи не удаляются.
+class StringPool {
+public:
+    struct Entry {
+        std::string text;
+        uint32_t id;
+    };
+
+    static const Entry* intern(std::string_view text);
+    // nullptr, если строка еще не встречалась
+    static const Entry* find(std::string_view text);
+    static size_t size();
+};
+
+// Ссылка на строку из StringPool: 8 байт вместо отдельной копии строки в каждом объекте
+class InternedString {
+private:
+    const StringPool::Entry* entry;
+
+public:
+    InternedString() : entry(StringPool::intern("")) {}
+    InternedString(const std::string& text) : entry(StringPool::intern(text)) {}
+
+    const std::string& str() const { return entry->text; }
+    uint32_t id() const { return entry->id; }
+
+    operator const std::string&() const { return entry->text; }
+
+    bool operator==(const InternedString& other) const { return entry == other.entry; }
+    bool operator!=(const InternedString& other) const { return entry != other.entry; }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const InternedString& text) {
+    return out << text.str();
+}
+#endif
@@ -0,0 +1,211 @@
+#include "textindex.h"
+#include <algorithm>
+
+namespace {
+    // Декодирование UTF-8; некорректные байты пропускаются
+    char32_t nextCodepoint(std::string_view text, size_t& pos) {
+        unsigned char lead = static_cast<unsigned char>(text[pos++]);
+        if (lead < 0x80) {
+            return lead;
+        }
+
+        int extra = (lead >= 0xF0) ? 3 : (lead >= 0xE0) ? 2 : (lead >= 0xC0) ? 1 : -1;
+        if (extra < 0 || pos + extra > text.size()) {
+            return 0;
+        }
+
+        char32_t codepoint = lead & (0x3F >> extra);
+        for (int i = 0; i < extra; i++) {
+            unsigned char next = static_cast<unsigned char>(text[pos]);
+            if ((next & 0xC0) != 0x80) {
+                return 0;
+            }
+            codepoint = (codepoint << 6) | (next & 0x3F);
+            pos++;
+        }
+        return codepoint;
+    }
+
+    char32_t foldCase(char32_t c) {
+        if (c >= U'A' && c <= U'Z') {
+            return c + 0x20;
+        }
+        if (c >= 0xC0 && c <= 0xDE && c != 0xD7) {
+            return c + 0x20;
+        }
+        if (c == 0x401 || c == 0x451) {
+            return 0x435;
+        }
+        if (c >= 0x410 && c <= 0x42F) {
+            return c + 0x20;
+        }
+        if (c >= 0x400 && c <= 0x40F) {
+            return c + 0x50;
+        }
+        return c;
+    }
+
+    uint64_t trigramKey(const char32_t* p) {
+        return (static_cast<uint64_t>(p[0]) << 42) | (static_cast<uint64_t>(p[1]) << 21) | p[2];
+    }
+
+    void intersect(std::vector<int>& result, const std::vector<int>& list) {
+        auto out = result.begin();
+        auto it = list.begin();
+        for (int id : result) {
+            it = std::lower_bound(it, list.end(), id);
+            if (it == list.end()) {
+                break;
+            }
+            if (*it == id) {
+                *out++ = id;
+            }
+        }
+        result.erase(out, result.end());
+    }
+}
+
+std::u32string TextIndex::normalize(std::string_view text) {
+    std::u32string result;
+    result.reserve(text.size());
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char32_t c = nextCodepoint(text, pos);
+        if (c != 0) {
+            result.push_back(foldCase(c));
+        }
+    }
+    return result;
+}
+
+void TextIndex::collectTrigrams(const std::u32string& text, std::vector<uint64_t>& trigrams) {
+    for (size_t i = 0; i + 3 <= text.size(); i++) {
+        trigrams.push_back(trigramKey(text.data() + i));
+    }
+}
+
+bool TextIndex::matches(const std::vector<std::u32string>& fields, const std::u32string& query, int field) {
+    if (field >= 0) {
+        return field < static_cast<int>(fields.size()) && fields[field].find(query) != std::u32string::npos;
+    }
+
+    for (const auto& text : fields) {
+        if (text.find(query) != std::u32string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TextIndex::add(int id, const std::vector<std::string>& fields) {
+    remove(id);
+
+    std::vector<std::u32string> normalized;
+    std::vector<uint64_t> trigrams;
+    normalized.reserve(fields.size());
+    for (const auto& text : fields) {
+        normalized.push_back(normalize(text));
+        collectTrigrams(normalized.back(), trigrams);
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    for (uint64_t trigram : trigrams) {
+        auto& list = postings[trigram];
+        // ID обычно растут, поэтому вставка почти всегда в конец
+        if (list.empty() || list.back() < id) {
+            list.push_back(id);
+        }
+        else {
+            list.insert(std::lower_bound(list.begin(), list.end(), id), id);
+        }
+    }
+
+    documents.emplace(id, std::move(normalized));
+}
+
+void TextIndex::remove(int id) {
+    auto doc = documents.find(id);
+    if (doc == documents.end()) {
+        return;
+    }
+
+    std::vector<uint64_t> trigrams;
+    for (const auto& text : doc->second) {
+        collectTrigrams(text, trigrams);
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    for (uint64_t trigram : trigrams) {
+        auto it = postings.find(trigram);
+        if (it == postings.end()) {
+            continue;
+        }
+
+        auto& list = it->second;
+        auto pos = std::lower_bound(list.begin(), list.end(), id);
+        if (pos != list.end() && *pos == id) {
+            list.erase(pos);
+        }
+        if (list.empty()) {
+            postings.erase(it);
+        }
+    }
+
+    documents.erase(doc);
+}
+
+void TextIndex::clear() {
+    postings.clear();
+    documents.clear();
+}
+
+std::vector<int> TextIndex::search(std::string_view query, int field) const {
+    std::u32string normalized = normalize(query);
+    std::vector<int> result;
+
+    // Запросы короче триграммы проверяются перебором
+    if (normalized.size() < 3) {
+        for (const auto& doc : documents) {
+            if (matches(doc.second, normalized, field)) {
+                result.push_back(doc.first);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    std::vector<uint64_t> trigrams;
+    collectTrigrams(normalized, trigrams);
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    std::vector<const std::vector<int>*> lists;
+    lists.reserve(trigrams.size());
+    for (uint64_t trigram : trigrams) {
+        auto it = postings.find(trigram);
+        if (it == postings.end()) {
+            return result;
+        }
+        lists.push_back(&it->second);
+    }
+
+    // Пересечение начинается с самого короткого списка
+    std::sort(lists.begin(), lists.end(),
+        [](const std::vector<int>* a, const std::vector<int>* b) { return a->size() < b->size(); });
+
+    result = *lists.front();
+    for (size_t i = 1; i < lists.size() && !result.empty(); i++) {
+        intersect(result, *lists[i]);
+    }
+
+    // Триграммы могут совпасть в разных местах или полях — подтверждаем подстроку
+    result.erase(std::remove_if(result.begin(), result.end(), [&](int id) {
+        return !matches(documents.at(id), normalized, field);
+    }), result.end());
+
+    return result;
+}
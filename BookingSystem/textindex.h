@@ -0,0 +1,34 @@
+#ifndef TEXTINDEX_H
+#define TEXTINDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Инвертированный индекс по триграммам для поиска подстроки без учета регистра.
+// Текст приводится к нижнему регистру с учетом кириллицы (ё считается равной е);
+// кандидаты получаются пересечением отсортированных списков ID и затем проверяются.
+class TextIndex {
+private:
+    std::unordered_map<uint64_t, std::vector<int>> postings;
+    std::unordered_map<int, std::vector<std::u32string>> documents;
+
+    static void collectTrigrams(const std::u32string& text, std::vector<uint64_t>& trigrams);
+    static bool matches(const std::vector<std::u32string>& fields, const std::u32string& query, int field);
+
+public:
+    static std::u32string normalize(std::string_view text);
+
+    // Добавляет или заменяет документ; поиск по подстроке ведется внутри каждого поля
+    void add(int id, const std::vector<std::string>& fields);
+    void remove(int id);
+    void clear();
+
+    // ID документов, содержащих query, по возрастанию; field >= 0 ограничивает поиск одним полем
+    std::vector<int> search(std::string_view query, int field = -1) const;
+
+    size_t size() const { return documents.size(); }
+};
+#endif
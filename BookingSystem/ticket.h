@@ -12,22 +12,36 @@ private:
     int eventId;
     int userId;
     double price;
-    std::string bookingTime;
+    DateTime bookingTime;
+    // Недействительно, пока билет не отменен
+    DateTime cancelTime;
+    int seatId;
     bool isActive;
 
 public:
+    // Билет без нумерованного места
+    static constexpr int NO_SEAT = -1;
+
     Ticket(int _id, int _eventId, int _userId, double _price);
+    Ticket(int _id, int _eventId, int _userId, double _price, const DateTime& _bookingTime);
 
     int getEventId() const { return eventId; }
     int getUserId() const { return userId; }
     double getPrice() const { return price; }
-    const std::string& getBookingTime() const { return bookingTime; }
+    std::string getBookingTime() const { return bookingTime.toString(); }
+    const DateTime& getBookingDateTime() const { return bookingTime; }
+    const DateTime& getCancelDateTime() const { return cancelTime; }
+    int getSeatId() const { return seatId; }
     bool getIsActive() const { return isActive; }
 
+    void setSeatId(int _seatId) { seatId = _seatId; }
     void setIsActive(bool status) { isActive = status; }
+    void setCancelDateTime(const DateTime& time) { cancelTime = time; }
 
     void display() const;
 
+    std::string toRecord() const;
+
     void saveToFile() const override;
 };
 #endif
@@ -0,0 +1,201 @@
+#include "tickettable.h"
+#include "ticket.h"
+#include <algorithm>
+#include <atomic>
+#include "tickettable_avx2.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+    int popcount(uint64_t word) {
+#ifdef _MSC_VER
+        return static_cast<int>(__popcnt64(word));
+#else
+        return __builtin_popcountll(word);
+#endif
+    }
+
+    // AVX2 должен поддерживать и процессор, и ОС (сохранение регистров YMM)
+    bool detectAvx2() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid(info, 1);
+        const int osxsave = 1 << 27;
+        const int avx = 1 << 28;
+        if ((info[2] & osxsave) == 0 || (info[2] & avx) == 0 || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+
+    const bool AVX2_SUPPORTED = detectAvx2();
+    std::atomic<bool> vectorized(AVX2_SUPPORTED);
+
+    // Число строк, которые считает векторное ядро; 0 — считать скалярным циклом
+    size_t vectorRows(size_t rows) {
+        return vectorized.load(std::memory_order_relaxed) ? rows - rows % 4 : 0;
+    }
+}
+
+bool TicketTable::isVectorized() {
+    return vectorized.load(std::memory_order_relaxed);
+}
+
+bool TicketTable::setVectorized(bool enabled) {
+    vectorized.store(enabled && AVX2_SUPPORTED, std::memory_order_relaxed);
+    return isVectorized();
+}
+
+void TicketTable::append(const Ticket& ticket) {
+    size_t row = ids.size();
+    ids.push_back(ticket.getId());
+    eventIds.push_back(ticket.getEventId());
+    userIds.push_back(ticket.getUserId());
+    prices.push_back(ticket.getPrice());
+    bookingTimes.push_back(ticket.getBookingDateTime().toSeconds());
+    cancelTimes.push_back(INT64_MIN);
+    seatIds.push_back(ticket.getSeatId());
+
+    if (row / 64 >= active.size()) {
+        active.push_back(0);
+    }
+    setActive(row, ticket.getIsActive(), ticket.getCancelDateTime().toSeconds());
+}
+
+void TicketTable::setActive(size_t row, bool isActive, int64_t cancelTime) {
+    cancelTimes[row] = isActive ? INT64_MIN : cancelTime;
+    uint64_t bit = uint64_t(1) << (row % 64);
+    if (isActive) {
+        active[row / 64] |= bit;
+    }
+    else {
+        active[row / 64] &= ~bit;
+    }
+}
+
+void TicketTable::removeRow(size_t row) {
+    size_t last = ids.size() - 1;
+    if (row != last) {
+        ids[row] = ids[last];
+        eventIds[row] = eventIds[last];
+        userIds[row] = userIds[last];
+        prices[row] = prices[last];
+        bookingTimes[row] = bookingTimes[last];
+        seatIds[row] = seatIds[last];
+        setActive(row, isActive(last), cancelTimes[last]);
+    }
+
+    ids.pop_back();
+    eventIds.pop_back();
+    userIds.pop_back();
+    prices.pop_back();
+    bookingTimes.pop_back();
+    cancelTimes.pop_back();
+    seatIds.pop_back();
+    // Бит удаленной строки сбрасывается, чтобы подсчет по словам карты его не учитывал
+    active[last / 64] &= ~(uint64_t(1) << (last % 64));
+    if (last % 64 == 0) {
+        active.pop_back();
+    }
+}
+
+void TicketTable::reserve(size_t count) {
+    ids.reserve(count);
+    eventIds.reserve(count);
+    userIds.reserve(count);
+    prices.reserve(count);
+    bookingTimes.reserve(count);
+    cancelTimes.reserve(count);
+    seatIds.reserve(count);
+    active.reserve(count / 64 + 1);
+}
+
+void TicketTable::clear() {
+    ids.clear();
+    eventIds.clear();
+    userIds.clear();
+    prices.clear();
+    bookingTimes.clear();
+    cancelTimes.clear();
+    seatIds.clear();
+    active.clear();
+}
+
+size_t TicketTable::countActive() const {
+    size_t count = 0;
+    for (uint64_t word : active) {
+        count += popcount(word);
+    }
+    return count;
+}
+
+double TicketTable::sumActivePrices() const {
+    size_t n = prices.size();
+    size_t row = vectorRows(n);
+    double sum = row > 0 ? tickettable_avx2::sumActivePrices(prices.data(), active.data(), row) : 0.0;
+
+    for (; row < n; row++) {
+        if (isActive(row)) {
+            sum += prices[row];
+        }
+    }
+    return sum;
+}
+
+double TicketTable::sumActivePricesForEvent(int eventId) const {
+    size_t n = prices.size();
+    size_t row = vectorRows(n);
+    double sum = row > 0 ?
+        tickettable_avx2::sumActivePricesForEvent(eventIds.data(), prices.data(), active.data(), row, eventId) : 0.0;
+
+    for (; row < n; row++) {
+        if (eventIds[row] == eventId && isActive(row)) {
+            sum += prices[row];
+        }
+    }
+    return sum;
+}
+
+double TicketTable::sumActivePricesInRange(double minPrice, double maxPrice) const {
+    size_t n = prices.size();
+    size_t row = vectorRows(n);
+    double sum = row > 0 ?
+        tickettable_avx2::sumActivePricesInRange(prices.data(), active.data(), row, minPrice, maxPrice) : 0.0;
+
+    for (; row < n; row++) {
+        if (prices[row] >= minPrice && prices[row] <= maxPrice && isActive(row)) {
+            sum += prices[row];
+        }
+    }
+    return sum;
+}
+
+std::vector<double> TicketTable::sumActivePricesByEvent() const {
+    // ID событий плотные, поэтому группировка идет в массив, а не в хеш-таблицу
+    int maxEventId = eventIds.empty() ? -1 : *std::max_element(eventIds.begin(), eventIds.end());
+    std::vector<double> sums(static_cast<size_t>(maxEventId + 1), 0.0);
+
+    for (size_t word = 0; word < active.size(); word++) {
+        uint64_t bits = active[word];
+        while (bits != 0) {
+            size_t row = word * 64 + popcount((bits & (0 - bits)) - 1);
+            int eventId = eventIds[row];
+            if (eventId >= 0) {
+                sums[eventId] += prices[row];
+            }
+            bits &= bits - 1;
+        }
+    }
+    return sums;
+}
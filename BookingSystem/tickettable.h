@@ -0,0 +1,57 @@
+#ifndef TICKETTABLE_H
+#define TICKETTABLE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class Ticket;
+
+// Билеты в колоночном виде: параллельные массивы полей и битовая карта активности.
+// Строка совпадает с позицией билета в реестре. Агрегаты считаются векторно
+// (AVX2, если его поддерживает процессор — проверяется при запуске), иначе — скалярным циклом.
+class TicketTable {
+private:
+    std::vector<int> ids;
+    std::vector<int> eventIds;
+    std::vector<int> userIds;
+    std::vector<double> prices;
+    std::vector<int64_t> bookingTimes;
+    std::vector<int64_t> cancelTimes;
+    std::vector<int> seatIds;
+    std::vector<uint64_t> active;
+
+public:
+    static bool isVectorized();
+    // Включает или выключает векторные ядра (для замеров); возвращает, используются ли они
+    static bool setVectorized(bool enabled);
+
+    void append(const Ticket& ticket);
+    // cancelTime — секунды DateTime времени отмены; для действующего билета не используется
+    void setActive(size_t row, bool isActive, int64_t cancelTime);
+    // Удаляет строку, перенося на ее место последнюю, — так же, как Registry::remove
+    void removeRow(size_t row);
+    void reserve(size_t count);
+    void clear();
+
+    size_t size() const { return ids.size(); }
+    bool isActive(size_t row) const { return (active[row / 64] >> (row % 64)) & 1; }
+
+    const std::vector<int>& getIds() const { return ids; }
+    const std::vector<int>& getEventIds() const { return eventIds; }
+    const std::vector<int>& getUserIds() const { return userIds; }
+    const std::vector<double>& getPrices() const { return prices; }
+    // Секунды DateTime; для нераспознанного времени — INT64_MIN
+    const std::vector<int64_t>& getBookingTimes() const { return bookingTimes; }
+    // Секунды DateTime; INT64_MIN, если билет действует или время отмены неизвестно
+    const std::vector<int64_t>& getCancelTimes() const { return cancelTimes; }
+    const std::vector<int>& getSeatIds() const { return seatIds; }
+
+    size_t countActive() const;
+    double sumActivePrices() const;
+    double sumActivePricesForEvent(int eventId) const;
+    double sumActivePricesInRange(double minPrice, double maxPrice) const;
+    // Сумма продаж по событиям; индекс вектора — ID события
+    std::vector<double> sumActivePricesByEvent() const;
+};
+#endif
@@ -0,0 +1,68 @@
+#include "tickettable_avx2.h"
+#include <immintrin.h>
+
+// MSVC получает /arch:AVX2 для этого файла в проекте, GCC и Clang — атрибутом функции
+#if defined(__GNUC__) && !defined(__AVX2__)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+namespace {
+    // Четыре бита активности, начиная с row (row кратно 4)
+    unsigned activeNibble(const uint64_t* active, size_t row) {
+        return static_cast<unsigned>(active[row / 64] >> (row % 64)) & 0xF;
+    }
+
+    // Маска из четырех битов: каждый бит растягивается на 64-битную дорожку
+    AVX2_TARGET __m256d nibbleMask(unsigned bits) {
+        const __m256i lanes = _mm256_set_epi64x(8, 4, 2, 1);
+        __m256i selected = _mm256_and_si256(_mm256_set1_epi64x(bits), lanes);
+        return _mm256_castsi256_pd(_mm256_cmpeq_epi64(selected, lanes));
+    }
+
+    AVX2_TARGET double horizontalSum(__m256d value) {
+        __m128d low = _mm256_castpd256_pd128(value);
+        __m128d high = _mm256_extractf128_pd(value, 1);
+        low = _mm_add_pd(low, high);
+        return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+    }
+}
+
+AVX2_TARGET double tickettable_avx2::sumActivePrices(const double* prices, const uint64_t* active, size_t rows) {
+    __m256d acc = _mm256_setzero_pd();
+    for (size_t row = 0; row < rows; row += 4) {
+        __m256d value = _mm256_loadu_pd(prices + row);
+        acc = _mm256_add_pd(acc, _mm256_and_pd(value, nibbleMask(activeNibble(active, row))));
+    }
+    return horizontalSum(acc);
+}
+
+AVX2_TARGET double tickettable_avx2::sumActivePricesForEvent(const int* eventIds, const double* prices,
+    const uint64_t* active, size_t rows, int eventId) {
+
+    __m256d acc = _mm256_setzero_pd();
+    __m128i target = _mm_set1_epi32(eventId);
+    for (size_t row = 0; row < rows; row += 4) {
+        __m128i events = _mm_loadu_si128(reinterpret_cast<const __m128i*>(eventIds + row));
+        __m256d match = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(_mm_cmpeq_epi32(events, target)));
+        __m256d mask = _mm256_and_pd(match, nibbleMask(activeNibble(active, row)));
+        acc = _mm256_add_pd(acc, _mm256_and_pd(_mm256_loadu_pd(prices + row), mask));
+    }
+    return horizontalSum(acc);
+}
+
+AVX2_TARGET double tickettable_avx2::sumActivePricesInRange(const double* prices, const uint64_t* active,
+    size_t rows, double minPrice, double maxPrice) {
+
+    __m256d acc = _mm256_setzero_pd();
+    __m256d low = _mm256_set1_pd(minPrice);
+    __m256d high = _mm256_set1_pd(maxPrice);
+    for (size_t row = 0; row < rows; row += 4) {
+        __m256d value = _mm256_loadu_pd(prices + row);
+        __m256d inRange = _mm256_and_pd(_mm256_cmp_pd(value, low, _CMP_GE_OQ), _mm256_cmp_pd(value, high, _CMP_LE_OQ));
+        __m256d mask = _mm256_and_pd(inRange, nibbleMask(activeNibble(active, row)));
+        acc = _mm256_add_pd(acc, _mm256_and_pd(value, mask));
+    }
+    return horizontalSum(acc);
+}
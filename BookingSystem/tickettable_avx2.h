@@ -0,0 +1,17 @@
+#ifndef TICKETTABLE_AVX2_H
+#define TICKETTABLE_AVX2_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Векторные ядра TicketTable. Файл собирается с поддержкой AVX2 (/arch:AVX2),
+// поэтому вызывать функции можно только после проверки процессора в TicketTable.
+// Обрабатываются первые rows строк; rows кратно 4, остаток досчитывает вызывающий.
+namespace tickettable_avx2 {
+    double sumActivePrices(const double* prices, const uint64_t* active, size_t rows);
+    double sumActivePricesForEvent(const int* eventIds, const double* prices, const uint64_t* active,
+        size_t rows, int eventId);
+    double sumActivePricesInRange(const double* prices, const uint64_t* active, size_t rows,
+        double minPrice, double maxPrice);
+}
+#endif
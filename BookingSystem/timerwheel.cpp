@@ -0,0 +1,38 @@
+#include "timerwheel.h"
+
+TimerWheel::TimerWheel(int64_t start) : current(start), count(0) {
+}
+
+void TimerWheel::schedule(int id, int64_t due, int64_t now) {
+    if (count == 0 && now > current) {
+        current = now;
+    }
+
+    // Уже наступившие таймеры сработают на следующем шаге
+    place(Timer{ (due > current) ? due : current + 1, id });
+    count++;
+}
+
+void TimerWheel::place(const Timer& timer) {
+    // Уровень — самый нижний, на котором номер ячейки таймера еще не пройден
+    for (int level = 0; level < LEVELS; level++) {
+        if (((timer.due ^ current) >> (SLOT_BITS * (level + 1))) == 0) {
+            slots[level][(timer.due >> (SLOT_BITS * level)) & (SLOTS - 1)].push_back(timer);
+            return;
+        }
+    }
+    overflow.push_back(timer);
+}
+
+void TimerWheel::cascade(int level) {
+    std::vector<Timer> moved;
+    moved.swap(slots[level][(current >> (SLOT_BITS * level)) & (SLOTS - 1)]);
+    if (level == LEVELS - 1) {
+        moved.insert(moved.end(), overflow.begin(), overflow.end());
+        overflow.clear();
+    }
+
+    for (const auto& timer : moved) {
+        place(timer);
+    }
+}
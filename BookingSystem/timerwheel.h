@@ -0,0 +1,71 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Иерархическое колесо таймеров с шагом в одну секунду: LEVELS уровней по SLOTS ячеек,
+// ячейка уровня k покрывает SLOTS^k секунд. Постановка таймера — O(1); при продвижении
+// времени таймеры верхних уровней переносятся вниз, а срабатывают из ячейки нижнего уровня,
+// поэтому каждый таймер обрабатывается за O(1) без просмотра остальных.
+// Отмены нет: владелец проверяет по ID, актуален ли сработавший таймер.
+class TimerWheel {
+private:
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int LEVELS = 4;
+
+    struct Timer {
+        int64_t due;
+        int id;
+    };
+
+    std::vector<Timer> slots[LEVELS][SLOTS];
+    // Таймеры дальше горизонта колеса (SLOTS^LEVELS секунд)
+    std::vector<Timer> overflow;
+    int64_t current;
+    size_t count;
+
+    void place(const Timer& timer);
+    void cascade(int level);
+
+public:
+    explicit TimerWheel(int64_t start = 0);
+
+    // now — текущее время; пустое колесо сразу переводится на него
+    void schedule(int id, int64_t due, int64_t now);
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Продвигает время до now и вызывает expire(id) для каждого наступившего таймера
+    template <typename Expire>
+    void advance(int64_t now, Expire expire) {
+        if (count == 0) {
+            current = (now > current) ? now : current;
+            return;
+        }
+
+        while (current < now) {
+            current++;
+            for (int level = LEVELS - 1; level > 0; level--) {
+                if ((current & ((int64_t(1) << (SLOT_BITS * level)) - 1)) == 0) {
+                    cascade(level);
+                }
+            }
+
+            std::vector<Timer> due;
+            due.swap(slots[0][current & (SLOTS - 1)]);
+            count -= due.size();
+            for (const auto& timer : due) {
+                expire(timer.id);
+            }
+
+            if (count == 0) {
+                current = now;
+            }
+        }
+    }
+};
+#endif
@@ -2,20 +2,22 @@
 #include "event.h"
 #include "ticket.h"
 #include "bookingsystem.h"
-#include <fstream>
 #include <sstream>
 
 User::User(int _id, const std::string& _name, const std::string& _email, const std::string& _phone)
     : IIdentifiable(_id), name(_name), email(_email), phone(_phone) {
 }
 
-bool User::bookTicket(std::shared_ptr<Event> event) {
-    if (event->getAvailableSeats() <= 0) {
-        return false;
+bool User::bookTicket(std::shared_ptr<Event> event, bool joinWaitlist) {
+    if (event->getAvailableSeats() > 0 && event->createTicket(shared_from_this())) {
+        return true;
     }
 
-    auto ticket = event->createTicket(shared_from_this());
-    return ticket != nullptr;
+    return joinWaitlist && BookingSystem::getInstance().joinWaitlist(event, shared_from_this()) != 0;
+}
+
+bool User::bookTickets(std::shared_ptr<Event> event, int count) {
+    return !BookingSystem::getInstance().createTickets(event, shared_from_this(), count).empty();
 }
 
 bool User::cancelTicket(int ticketId) {
@@ -48,47 +50,12 @@ void User::display() const {
     }
 }
 
-void User::saveToFile() const {
-    bool exists = false;
-    int lineToReplace = -1;
-    std::string line;
-    std::ifstream inFile("users.txt");
-    std::vector<std::string> lines;
-
-    if (inFile.is_open()) {
-        int lineNum = 0;
-        while (std::getline(inFile, line)) {
-            lines.push_back(line);
-            std::istringstream iss(line);
-            int userId;
-            iss >> userId;
-            if (userId == id) {
-                exists = true;
-                lineToReplace = lineNum;
-            }
-            lineNum++;
-        }
-        inFile.close();
-    }
-
-    if (exists) {
-        std::ostringstream newLine;
-        newLine << id << "\t" << name << "\t" << email << "\t" << phone;
-        lines[lineToReplace] = newLine.str();
+std::string User::toRecord() const {
+    std::ostringstream record;
+    record << id << "\t" << name << "\t" << email << "\t" << phone;
+    return record.str();
+}
 
-        std::ofstream outFile("users.txt", std::ios::trunc);
-        if (outFile.is_open()) {
-            for (const auto& l : lines) {
-                outFile << l << std::endl;
-            }
-            outFile.close();
-        }
-    }
-    else {
-        std::ofstream file("users.txt", std::ios::app);
-        if (file.is_open()) {
-            file << id << "\t" << name << "\t" << email << "\t" << phone << std::endl;
-            file.close();
-        }
-    }
+void User::saveToFile() const {
+    BookingSystem::getInstance().getJournal().append("User", toRecord());
 }
@@ -29,7 +29,11 @@ public:
     void setEmail(const std::string& _email) { email = _email; }
     void setPhone(const std::string& _phone) { phone = _phone; }
 
-    bool bookTicket(std::shared_ptr<Event> event);
+    // Если мест нет и joinWaitlist = true, пользователь встает в лист ожидания события
+    bool bookTicket(std::shared_ptr<Event> event, bool joinWaitlist = false);
+
+    // Групповое бронирование: либо все count мест, либо ни одного
+    bool bookTickets(std::shared_ptr<Event> event, int count);
 
     bool cancelTicket(int ticketId);
 
@@ -41,6 +45,8 @@ public:
 
     void display() const;
 
+    std::string toRecord() const;
+
     void saveToFile() const override;
 };
 #endif
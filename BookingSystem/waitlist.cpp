@@ -0,0 +1,35 @@
+#include "waitlist.h"
+#include <algorithm>
+
+Waitlist::Waitlist() : bankedSeats(0) {
+}
+
+void Waitlist::push(const WaitlistEntry& entry, int priority) {
+    priority = std::min(std::max(priority, 0), PRIORITY_LEVELS - 1);
+    queues[priority].push_back(entry);
+    waiting.insert(entry.id);
+}
+
+bool Waitlist::remove(int entryId) {
+    return waiting.erase(entryId) > 0;
+}
+
+const WaitlistEntry* Waitlist::front() {
+    for (auto& queue : queues) {
+        // Вышедшие из очереди заявки удаляются здесь; каждая — один раз
+        while (!queue.empty() && waiting.count(queue.front().id) == 0) {
+            queue.pop_front();
+        }
+        if (!queue.empty()) {
+            return &queue.front();
+        }
+    }
+    return nullptr;
+}
+
+void Waitlist::pop() {
+    if (const WaitlistEntry* entry = front()) {
+        waiting.erase(entry->id);
+        front();
+    }
+}
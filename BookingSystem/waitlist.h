@@ -0,0 +1,48 @@
+#ifndef WAITLIST_H
+#define WAITLIST_H
+
+#include <deque>
+#include <unordered_set>
+#include <cstddef>
+
+// Во что превращается заявка из листа ожидания, когда для нее освобождаются места
+enum class WaitlistPromotion { TICKET, HOLD };
+
+struct WaitlistEntry {
+    int id;
+    int userId;
+    int count;
+    WaitlistPromotion promotion;
+};
+
+// Лист ожидания одного события: очередь FIFO для каждого уровня приоритета (0 — высший).
+// Постановка, выход из очереди и выдача первой заявки — O(1): вышедшие заявки только
+// помечаются и пропускаются, когда доходят до начала очереди.
+class Waitlist {
+public:
+    static const int PRIORITY_LEVELS = 4;
+
+private:
+    std::deque<WaitlistEntry> queues[PRIORITY_LEVELS];
+    std::unordered_set<int> waiting;
+    // Освобожденные места, придержанные для заявок, которым их пока не хватает
+    int bankedSeats;
+
+public:
+    Waitlist();
+
+    void push(const WaitlistEntry& entry, int priority = PRIORITY_LEVELS - 1);
+    bool remove(int entryId);
+
+    // Первая действующая заявка с учетом приоритета; nullptr, если очередь пуста
+    const WaitlistEntry* front();
+    void pop();
+
+    size_t size() const { return waiting.size(); }
+    bool empty() const { return waiting.empty(); }
+
+    int getBankedSeats() const { return bankedSeats; }
+    void bank(int count) { bankedSeats += count; }
+    void unbank(int count) { bankedSeats -= count; }
+};
+#endif
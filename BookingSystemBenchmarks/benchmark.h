@@ -0,0 +1,30 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <algorithm>
+#include <string>
+
+// Результат замера сохраняется сюда, чтобы компилятор не выбросил вычисления
+void keepResult(double value);
+
+// Лучшее время из repeats прогонов, в миллисекундах
+template <typename F>
+double measureMilliseconds(F run, int repeats = 5) {
+    double best = 0.0;
+    for (int i = 0; i < repeats; i++) {
+        auto start = std::chrono::steady_clock::now();
+        keepResult(run());
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = (i == 0) ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+void printTiming(const std::string& name, double milliseconds, size_t items);
+void printSpeedup(double baselineMilliseconds, double milliseconds);
+
+void benchRecordReader();
+void benchTicketTable();
+void benchPool();
+#endif
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "benchmark.h"
+
+namespace {
+    struct Benchmark {
+        const char* name;
+        const char* description;
+        void (*run)();
+    };
+
+    const Benchmark BENCHMARKS[] = {
+        { "recordreader", "Разбор записей: RecordReader против getline + istringstream", benchRecordReader },
+        { "tickettable", "Агрегаты продаж: TicketTable против обхода shared_ptr<Ticket>", benchTicketTable },
+        { "pool", "Загрузка объектов: makePooled против std::make_shared", benchPool },
+    };
+
+    volatile double sink;
+}
+
+void keepResult(double value) {
+    sink = value;
+}
+
+void printTiming(const std::string& name, double milliseconds, size_t items) {
+    std::cout << "  " << name << ": " << std::fixed << std::setprecision(1) << milliseconds << " мс";
+    if (items > 0 && milliseconds > 0) {
+        std::cout << ", " << std::setprecision(0) << items / milliseconds * 1000.0 << " в секунду";
+    }
+    std::cout << "\n";
+}
+
+void printSpeedup(double baselineMilliseconds, double milliseconds) {
+    std::cout << "  Ускорение: " << std::fixed << std::setprecision(1)
+        << (milliseconds > 0 ? baselineMilliseconds / milliseconds : 0.0) << "x\n";
+}
+
+// Запуск: BookingSystemBenchmarks [имя замера]; без аргументов выполняются все замеры
+int main(int argc, char* argv[]) {
+    std::string selected = (argc > 1) ? argv[1] : "";
+    bool found = false;
+
+    for (const auto& benchmark : BENCHMARKS) {
+        if (!selected.empty() && selected != benchmark.name) {
+            continue;
+        }
+        found = true;
+        std::cout << "\n=== " << benchmark.name << ": " << benchmark.description << " ===\n";
+        benchmark.run();
+    }
+
+    if (!found) {
+        std::cout << "Неизвестный замер: " << selected << ". Доступны:";
+        for (const auto& benchmark : BENCHMARKS) {
+            std::cout << " " << benchmark.name;
+        }
+        std::cout << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include "benchmark.h"
+#include "poolallocator.h"
+#include "recordreader.h"
+#include "datetime.h"
+#include "ticket.h"
+#include "user.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "Psapi.lib")
+#endif
+
+// Загрузка билетов и пользователей из текстовых записей: std::make_shared против makePooled.
+// Сравниваются время загрузки, прирост резидентной памяти и скорость обхода загруженных билетов.
+namespace {
+    const int TICKET_COUNT = 1000000;
+    const int USER_COUNT = 200000;
+    const int QUERY_REPEATS = 5;
+
+    struct Loaded {
+        std::vector<std::shared_ptr<Ticket>> tickets;
+        std::vector<std::shared_ptr<User>> users;
+    };
+
+    size_t residentBytes() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return counters.WorkingSetSize;
+        }
+        return 0;
+#else
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, 6, "VmRSS:") == 0) {
+                return std::stoul(line.substr(6)) * 1024;
+            }
+        }
+        return 0;
+#endif
+    }
+
+    // Пользователь на каждые пять билетов: загрузчик чередует выделения разных размеров
+    std::string makeRecords() {
+        std::string content;
+        DateTime start("2026-01-01 00:00:00");
+        for (int i = 1; i <= TICKET_COUNT; i++) {
+            Ticket ticket(i, 1 + i % 500, 1 + i % USER_COUNT, 1000.0 + i % 3000 * 0.5, start.addSeconds(i * 37));
+            ticket.setIsActive(i % 10 != 0);
+            content += "T\t" + ticket.toRecord() + "\n";
+            if (i % (TICKET_COUNT / USER_COUNT) == 0) {
+                int id = i / (TICKET_COUNT / USER_COUNT);
+                User user(id, "Пользователь " + std::to_string(id), "user" + std::to_string(id) + "@example.com",
+                    "+7-900-" + std::to_string(1000000 + id));
+                content += "U\t" + user.toRecord() + "\n";
+            }
+        }
+        return content;
+    }
+
+    template <typename MakeTicket, typename MakeUser>
+    void load(const std::string& content, Loaded& loaded, MakeTicket makeTicket, MakeUser makeUser) {
+        loaded.tickets.reserve(TICKET_COUNT);
+        loaded.users.reserve(USER_COUNT);
+
+        LineReader lines(content);
+        std::string_view line;
+        std::string name, email, phone;
+        while (lines.next(line)) {
+            RecordReader reader(line);
+            std::string_view kind;
+            reader.next(kind);
+            if (kind == "T") {
+                int id, eventId, userId;
+                double price;
+                std::string_view bookingTime, status;
+                if (reader.next(id) && reader.next(eventId) && reader.next(userId) && reader.next(price) &&
+                    reader.next(bookingTime) && reader.next(status)) {
+                    auto ticket = makeTicket(id, eventId, userId, price, DateTime(bookingTime));
+                    ticket->setIsActive(status == "active");
+                    loaded.tickets.push_back(std::move(ticket));
+                }
+            }
+            else {
+                int id;
+                if (reader.next(id) && reader.next(name) && reader.next(email) && reader.next(phone)) {
+                    loaded.users.push_back(makeUser(id, name, email, phone));
+                }
+            }
+        }
+    }
+
+    double sumActivePrices(const Loaded& loaded) {
+        double sum = 0.0;
+        for (const auto& ticket : loaded.tickets) {
+            if (ticket->getIsActive()) {
+                sum += ticket->getPrice();
+            }
+        }
+        return sum;
+    }
+
+    struct Result {
+        double loadMilliseconds;
+        double queryMilliseconds;
+        size_t residentGrowth;
+        double checksum;
+    };
+
+    template <typename MakeTicket, typename MakeUser>
+    Result measure(const std::string& content, Loaded& loaded, MakeTicket makeTicket, MakeUser makeUser) {
+        Result result;
+        size_t before = residentBytes();
+        result.loadMilliseconds = measureMilliseconds([&]() {
+            load(content, loaded, makeTicket, makeUser);
+            return static_cast<double>(loaded.tickets.size());
+        }, 1);
+        size_t after = residentBytes();
+        result.residentGrowth = after > before ? after - before : 0;
+        result.queryMilliseconds = measureMilliseconds([&]() { return sumActivePrices(loaded); }, QUERY_REPEATS);
+        result.checksum = sumActivePrices(loaded);
+        return result;
+    }
+
+    void print(const char* name, const Result& result) {
+        std::cout << "  " << name << ":\n";
+        printTiming("загрузка", result.loadMilliseconds, TICKET_COUNT + USER_COUNT);
+        std::cout << "  прирост памяти: " << result.residentGrowth / 1024 / 1024 << " МБ\n";
+        printTiming("обход билетов", result.queryMilliseconds, TICKET_COUNT);
+    }
+}
+
+void benchPool() {
+    std::string content = makeRecords();
+    std::cout << "  Билетов: " << TICKET_COUNT << ", пользователей: " << USER_COUNT << "\n";
+
+    // Оба набора живут до конца замера: иначе второй получил бы память, освобожденную
+    // первым, и прирост памяти оказался бы заниженным
+    Loaded pooledData;
+    Loaded sharedData;
+    Result pooled = measure(content, pooledData,
+        [](int id, int eventId, int userId, double price, const DateTime& time) {
+            return makePooled<Ticket>(id, eventId, userId, price, time);
+        },
+        [](int id, const std::string& name, const std::string& email, const std::string& phone) {
+            return makePooled<User>(id, name, email, phone);
+        });
+    Result shared = measure(content, sharedData,
+        [](int id, int eventId, int userId, double price, const DateTime& time) {
+            return std::make_shared<Ticket>(id, eventId, userId, price, time);
+        },
+        [](int id, const std::string& name, const std::string& email, const std::string& phone) {
+            return std::make_shared<User>(id, name, email, phone);
+        });
+
+    if (pooled.checksum != shared.checksum) {
+        std::cout << "  ОШИБКА: результаты загрузки различаются\n";
+        return;
+    }
+
+    print("std::make_shared", shared);
+    print("makePooled", pooled);
+    std::cout << "  makePooled против std::make_shared, загрузка и обход:\n";
+    printSpeedup(shared.loadMilliseconds, pooled.loadMilliseconds);
+    printSpeedup(shared.queryMilliseconds, pooled.queryMilliseconds);
+}
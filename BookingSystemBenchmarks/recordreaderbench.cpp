@@ -0,0 +1,154 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include "benchmark.h"
+#include "recordreader.h"
+#include "datetime.h"
+#include "ticket.h"
+#include "user.h"
+
+// Сравнение RecordReader с прежним разбором файлов данных: std::getline по строкам,
+// std::istringstream и operator>> по полям, DateTime через substr и std::stoi.
+namespace {
+    const int TICKET_COUNT = 1000000;
+    const int USER_COUNT = 200000;
+
+    std::string makeTickets() {
+        std::string content;
+        DateTime start("2026-01-01 00:00:00");
+        for (int i = 1; i <= TICKET_COUNT; i++) {
+            Ticket ticket(i, 1 + i % 500, 1 + i % USER_COUNT, 1000.0 + i % 3000 * 0.5, start.addSeconds(i * 37));
+            ticket.setIsActive(i % 10 != 0);
+            content += ticket.toRecord();
+            content += '\n';
+        }
+        return content;
+    }
+
+    // Без пробелов в полях: прежний разбор делит поля по пробельным символам
+    std::string makeUsers() {
+        std::string content;
+        for (int i = 1; i <= USER_COUNT; i++) {
+            User user(i, "Пользователь_" + std::to_string(i), "user" + std::to_string(i) + "@example.com",
+                "+7-900-" + std::to_string(1000000 + i));
+            content += user.toRecord();
+            content += '\n';
+        }
+        return content;
+    }
+
+    // Прежний конструктор DateTime
+    DateTime legacyDateTime(const std::string& text) {
+        if (text.length() < 10) {
+            return DateTime();
+        }
+        try {
+            int year = std::stoi(text.substr(0, 4));
+            int month = std::stoi(text.substr(5, 2));
+            int day = std::stoi(text.substr(8, 2));
+            int hour = 0, minute = 0, second = 0;
+            if (text.length() >= 19) {
+                hour = std::stoi(text.substr(11, 2));
+                minute = std::stoi(text.substr(14, 2));
+                second = std::stoi(text.substr(17, 2));
+            }
+            return DateTime::fromFields(year, month, day, hour, minute, second);
+        }
+        catch (const std::exception&) {
+            return DateTime();
+        }
+    }
+
+    // Время бронирования содержит пробел, поэтому operator>> читает дату и время отдельными полями
+    double parseTicketsWithStreams(const std::string& content) {
+        std::istringstream file(content);
+        std::string line;
+        double checksum = 0.0;
+        while (std::getline(file, line)) {
+            std::istringstream iss(line);
+            int id, eventId, userId, seatId;
+            double price;
+            std::string date, time, status;
+            if (iss >> id >> eventId >> userId >> price >> date >> time >> status >> seatId) {
+                DateTime bookingTime = legacyDateTime(date + " " + time);
+                checksum += id + price + (status == "active") + static_cast<double>(bookingTime.toSeconds() % 1000);
+            }
+        }
+        return checksum;
+    }
+
+    double parseTicketsWithRecordReader(const std::string& content) {
+        LineReader lines(content);
+        std::string_view line;
+        double checksum = 0.0;
+        while (lines.next(line)) {
+            RecordReader reader(line);
+            int id, eventId, userId, seatId;
+            double price;
+            std::string_view bookingTime, status;
+            if (reader.next(id) && reader.next(eventId) && reader.next(userId) && reader.next(price) &&
+                reader.next(bookingTime) && reader.next(status) && reader.next(seatId)) {
+                DateTime time(bookingTime);
+                checksum += id + price + (status == "active") + static_cast<double>(time.toSeconds() % 1000);
+            }
+        }
+        return checksum;
+    }
+
+    double parseUsersWithStreams(const std::string& content) {
+        std::istringstream file(content);
+        std::string line;
+        double checksum = 0.0;
+        while (std::getline(file, line)) {
+            std::istringstream iss(line);
+            int id;
+            std::string name, email, phone;
+            if (iss >> id >> name >> email >> phone) {
+                checksum += id + name.size() + email.size() + phone.size();
+            }
+        }
+        return checksum;
+    }
+
+    // Строки копируются в std::string, как это делает загрузчик при создании User
+    double parseUsersWithRecordReader(const std::string& content) {
+        LineReader lines(content);
+        std::string_view line;
+        std::string name, email, phone;
+        double checksum = 0.0;
+        while (lines.next(line)) {
+            RecordReader reader(line);
+            int id;
+            if (reader.next(id) && reader.next(name) && reader.next(email) && reader.next(phone)) {
+                checksum += id + name.size() + email.size() + phone.size();
+            }
+        }
+        return checksum;
+    }
+}
+
+void benchRecordReader() {
+    std::string tickets = makeTickets();
+    std::string users = makeUsers();
+    std::cout << "  Билетов: " << TICKET_COUNT << " (" << tickets.size() / 1024 / 1024 << " МБ), пользователей: "
+        << USER_COUNT << " (" << users.size() / 1024 / 1024 << " МБ)\n";
+
+    if (parseTicketsWithStreams(tickets) != parseTicketsWithRecordReader(tickets) ||
+        parseUsersWithStreams(users) != parseUsersWithRecordReader(users)) {
+        std::cout << "  ОШИБКА: результаты разбора различаются\n";
+        return;
+    }
+
+    double streamTickets = measureMilliseconds([&]() { return parseTicketsWithStreams(tickets); }, 3);
+    double readerTickets = measureMilliseconds([&]() { return parseTicketsWithRecordReader(tickets); }, 3);
+    printTiming("Билеты, getline + istringstream", streamTickets, TICKET_COUNT);
+    printTiming("Билеты, RecordReader", readerTickets, TICKET_COUNT);
+    printSpeedup(streamTickets, readerTickets);
+
+    double streamUsers = measureMilliseconds([&]() { return parseUsersWithStreams(users); }, 3);
+    double readerUsers = measureMilliseconds([&]() { return parseUsersWithRecordReader(users); }, 3);
+    printTiming("Пользователи, getline + istringstream", streamUsers, USER_COUNT);
+    printTiming("Пользователи, RecordReader", readerUsers, USER_COUNT);
+    printSpeedup(streamUsers, readerUsers);
+}
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <numeric>
+#include "benchmark.h"
+#include "tickettable.h"
+#include "ticket.h"
+#include "datetime.h"
+
+// Агрегаты по билетам: std::accumulate по вектору shared_ptr<Ticket> (как хранит реестр)
+// против колоночной TicketTable со скалярным циклом и с ядрами AVX2.
+namespace {
+    const int TICKET_COUNT = 2000000;
+    const int EVENT_COUNT = 500;
+    const int HOT_EVENT = 7;
+
+    std::vector<std::shared_ptr<Ticket>> makeTickets() {
+        std::vector<std::shared_ptr<Ticket>> tickets;
+        tickets.reserve(TICKET_COUNT);
+        DateTime start("2026-01-01 00:00:00");
+        for (int i = 1; i <= TICKET_COUNT; i++) {
+            auto ticket = std::make_shared<Ticket>(i, 1 + i % EVENT_COUNT, 1 + i % 10000,
+                1000.0 + i % 3000 * 0.5, start.addSeconds(i * 37));
+            ticket->setIsActive(i % 10 != 0);
+            tickets.push_back(ticket);
+        }
+        return tickets;
+    }
+
+    double sumActive(const std::vector<std::shared_ptr<Ticket>>& tickets) {
+        return std::accumulate(tickets.begin(), tickets.end(), 0.0,
+            [](double sum, const std::shared_ptr<Ticket>& ticket) {
+                return ticket->getIsActive() ? sum + ticket->getPrice() : sum;
+            });
+    }
+
+    double sumActiveForEvent(const std::vector<std::shared_ptr<Ticket>>& tickets, int eventId) {
+        return std::accumulate(tickets.begin(), tickets.end(), 0.0,
+            [eventId](double sum, const std::shared_ptr<Ticket>& ticket) {
+                return ticket->getIsActive() && ticket->getEventId() == eventId ? sum + ticket->getPrice() : sum;
+            });
+    }
+
+    // Время скалярного и векторного вариантов одного агрегата; AVX2 — только при поддержке процессором
+    template <typename F>
+    void compare(const char* name, double objectsMilliseconds, F aggregate) {
+        TicketTable::setVectorized(false);
+        double scalar = measureMilliseconds(aggregate);
+        std::cout << "  " << name << ":\n";
+        printTiming("shared_ptr<Ticket> + std::accumulate", objectsMilliseconds, TICKET_COUNT);
+        printTiming("TicketTable, скалярный цикл", scalar, TICKET_COUNT);
+        printSpeedup(objectsMilliseconds, scalar);
+
+        if (TicketTable::setVectorized(true)) {
+            double vector = measureMilliseconds(aggregate);
+            printTiming("TicketTable, AVX2", vector, TICKET_COUNT);
+            printSpeedup(objectsMilliseconds, vector);
+        }
+    }
+}
+
+void benchTicketTable() {
+    auto tickets = makeTickets();
+    TicketTable table;
+    table.reserve(tickets.size());
+    for (const auto& ticket : tickets) {
+        table.append(*ticket);
+    }
+
+    bool avx2 = TicketTable::isVectorized();
+    std::cout << "  Билетов: " << TICKET_COUNT << ", AVX2: " << (avx2 ? "есть" : "нет") << "\n";
+
+    // Порядок сложения у ядер другой, поэтому суммы сравниваются с допуском
+    double expected = sumActive(tickets);
+    double expectedEvent = sumActiveForEvent(tickets, HOT_EVENT);
+    TicketTable::setVectorized(false);
+    bool scalarMatches = table.sumActivePrices() == expected && table.sumActivePricesForEvent(HOT_EVENT) == expectedEvent;
+    TicketTable::setVectorized(avx2);
+    double difference = table.sumActivePrices() - expected;
+    if (!scalarMatches || difference > 1e-6 * expected || difference < -1e-6 * expected) {
+        std::cout << "  ОШИБКА: суммы различаются\n";
+        return;
+    }
+
+    double objects = measureMilliseconds([&]() { return sumActive(tickets); });
+    compare("Сумма активных билетов", objects, [&]() { return table.sumActivePrices(); });
+
+    double objectsEvent = measureMilliseconds([&]() { return sumActiveForEvent(tickets, HOT_EVENT); });
+    compare("Сумма по одному событию", objectsEvent, [&]() { return table.sumActivePricesForEvent(HOT_EVENT); });
+
+    TicketTable::setVectorized(avx2);
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "tests.h"
+
+namespace {
+    struct Test {
+        const char* name;
+        const char* description;
+        void (*run)();
+    };
+
+    const Test TESTS[] = {
+        { "stress", "Конкурентное бронирование и отмена на одно событие", testConcurrentBooking },
+        { "suggest", "Подсказки при вводе: лучшие совпадения по выбранному порядку", testSuggestions },
+    };
+
+    int failures = 0;
+}
+
+void check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cout << "ОШИБКА: " << message << "\n";
+        failures++;
+    }
+}
+
+// Запуск: BookingSystemTests [имя теста]; без аргументов выполняются все тесты
+int main(int argc, char* argv[]) {
+    std::string selected = (argc > 1) ? argv[1] : "";
+    bool found = false;
+
+    for (const auto& test : TESTS) {
+        if (!selected.empty() && selected != test.name) {
+            continue;
+        }
+        found = true;
+        std::cout << "\n=== " << test.name << ": " << test.description << " ===\n";
+        test.run();
+    }
+
+    if (!found) {
+        std::cout << "Неизвестный тест: " << selected << ". Доступны:";
+        for (const auto& test : TESTS) {
+            std::cout << " " << test.name;
+        }
+        std::cout << "\n";
+        return EXIT_FAILURE;
+    }
+
+    if (failures > 0) {
+        std::cout << "Проверок не пройдено: " << failures << "\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "Все проверки пройдены\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <unordered_set>
+#include "tests.h"
+#include "bookingsystem.h"
+
+// Нагрузочная проверка конкурентного бронирования: N потоков покупают и отменяют билеты
+// на одно событие, после чего проверяется, что места не проданы дважды и счетчики сходятся.
+
+namespace {
+    const int TOTAL_SEATS = 1000;
+    const int ROWS = 20;
+    const int ITERATIONS_PER_THREAD = 500;
+
+    struct ThreadResult {
+        int booked = 0;
+        int canceled = 0;
+    };
+
+    // Схема зала "Партер:50,50,...": ROWS рядов по TOTAL_SEATS / ROWS мест
+    std::string makeLayout() {
+        std::string layout = "Партер:";
+        for (int row = 0; row < ROWS; row++) {
+            layout += (row > 0 ? "," : "") + std::to_string(TOTAL_SEATS / ROWS);
+        }
+        return layout;
+    }
+
+    void bookAndCancel(BookingSystem& system, const std::shared_ptr<Event>& event,
+        const std::shared_ptr<User>& user, unsigned seed, ThreadResult& result) {
+        std::mt19937 random(seed);
+        std::vector<int> own;
+
+        for (int i = 0; i < ITERATIONS_PER_THREAD; i++) {
+            int roll = static_cast<int>(random() % 10);
+            if (roll < 6) {
+                if (auto ticket = system.createTicket(event, user)) {
+                    own.push_back(ticket->getId());
+                    result.booked++;
+                }
+            }
+            else if (roll < 8) {
+                int count = 2 + static_cast<int>(random() % 3);
+                for (const auto& ticket : system.createTickets(event, user, count)) {
+                    own.push_back(ticket->getId());
+                    result.booked++;
+                }
+            }
+            else if (!own.empty()) {
+                size_t index = random() % own.size();
+                if (system.cancelTicket(own[index])) {
+                    result.canceled++;
+                }
+                own[index] = own.back();
+                own.pop_back();
+            }
+        }
+    }
+
+    // Инварианты после того, как все потоки завершились
+    int verify(BookingSystem& system, const std::shared_ptr<Event>& event, int expectedActive) {
+        int active = 0;
+        std::unordered_set<int> ticketIds;
+        std::unordered_set<int> seats;
+        const SeatMap* seatMap = event->getSeatMap();
+
+        system.forEachTicketOfEvent(event->getId(), [&](const Ticket& ticket, const Event*) {
+            check(ticketIds.insert(ticket.getId()).second,
+                "билет " + std::to_string(ticket.getId()) + " выдан дважды");
+            if (!ticket.getIsActive()) {
+                return;
+            }
+
+            active++;
+            int seat = ticket.getSeatId();
+            check(seat != Ticket::NO_SEAT, "у билета " + std::to_string(ticket.getId()) + " нет места");
+            check(seats.insert(seat).second, "место " + std::to_string(seat) + " продано дважды");
+            check(!seatMap->isFree(seat), "место " + std::to_string(seat) + " продано, но свободно в схеме зала");
+        });
+
+        int available = event->getAvailableSeats();
+        check(active == expectedActive, "активных билетов " + std::to_string(active) +
+            ", ожидалось " + std::to_string(expectedActive));
+        check(active + available == event->getTotalSeats(), "продано " + std::to_string(active) +
+            " + свободно " + std::to_string(available) + " != " + std::to_string(event->getTotalSeats()));
+        check(seatMap->getFreeCount() == available, "свободных мест в схеме зала " +
+            std::to_string(seatMap->getFreeCount()) + ", у события " + std::to_string(available));
+        check(system.getEventSalesStats(event->getId()).getActiveCount() == active,
+            "итоги продаж не совпадают с билетами");
+        return active;
+    }
+}
+
+void testConcurrentBooking() {
+    BookingSystem& system = BookingSystem::getInstance();
+    system.setDataDirectory("stresstest_data/");
+
+    auto event = system.createConcert("Нагрузочный тест", "2030-01-01", "Арена", TOTAL_SEATS, 1000.0,
+        "Исполнитель", "Рок");
+    auto user = system.createUser("Тестовый пользователь", "test@example.com", "+7-900-000-0000");
+    if (!system.setSeatLayout(event, makeLayout())) {
+        check(false, "не удалось задать схему зала");
+        BookingSystem::destroy();
+        return;
+    }
+
+    unsigned threadCount = std::max(8u, 2 * std::thread::hardware_concurrency());
+    std::vector<ThreadResult> results(threadCount);
+    std::vector<std::thread> threads;
+
+    // Сообщения о нехватке мест ожидаемы и только засоряют вывод
+    std::cout.setstate(std::ios::failbit);
+    for (unsigned i = 0; i < threadCount; i++) {
+        threads.emplace_back(bookAndCancel, std::ref(system), event, user, i + 1, std::ref(results[i]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::cout.clear();
+
+    int booked = 0;
+    int canceled = 0;
+    for (const auto& result : results) {
+        booked += result.booked;
+        canceled += result.canceled;
+    }
+    int active = verify(system, event, booked - canceled);
+    std::cout << "Потоков: " << threadCount << ", куплено: " << booked << ", отменено: " << canceled
+        << ", продано: " << active << ", свободно: " << event->getAvailableSeats() << "\n";
+
+    // Параллельная отмена всех оставшихся билетов возвращает зал в исходное состояние
+    auto remaining = system.getTicketsByEvent(event->getId());
+    threads.clear();
+    for (unsigned i = 0; i < threadCount; i++) {
+        threads.emplace_back([&system, &remaining, i, threadCount]() {
+            for (size_t j = i; j < remaining.size(); j += threadCount) {
+                system.cancelTicket(remaining[j]->getId());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    verify(system, event, 0);
+
+    BookingSystem::destroy();
+}
@@ -0,0 +1,52 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include "tests.h"
+#include "bookingsystem.h"
+
+// Подсказки выбирают лучшие события среди всех совпадений с префиксом, а не среди
+// первых по алфавиту: лучшее по порядку событие нарочно стоит в алфавите последним.
+
+namespace {
+    std::string namesOf(const std::vector<std::shared_ptr<Event>>& events) {
+        std::string names;
+        for (const auto& event : events) {
+            names += (names.empty() ? "" : ", ") + event->getName();
+        }
+        return names;
+    }
+
+    void expectNames(const std::vector<std::shared_ptr<Event>>& actual,
+        const std::vector<std::string>& expected, const std::string& what) {
+        bool same = actual.size() == expected.size();
+        for (size_t i = 0; same && i < actual.size(); i++) {
+            same = actual[i]->getName() == expected[i];
+        }
+        check(same, what + ": получено [" + namesOf(actual) + "]");
+    }
+}
+
+void testSuggestions() {
+    BookingSystem& system = BookingSystem::getInstance();
+    system.setDataDirectory("suggesttest_data/");
+
+    // По алфавиту: А, Б, В, Г, Д; ближайшее будущее — Г, больше всего мест — Д
+    system.createConcert("Фестиваль А", "2000-06-01", "Арена", 100, 1000.0, "Группа", "Рок");
+    system.createConcert("Фестиваль Б", "2033-06-01", "Арена", 200, 1000.0, "Группа", "Рок");
+    system.createConcert("Фестиваль В", "2032-06-01", "Арена", 300, 1000.0, "Группа", "Рок");
+    system.createConcert("Фестиваль Г", "2030-06-01", "Арена", 100, 1000.0, "Группа", "Рок");
+    system.createConcert("Фестиваль Д", "2034-06-01", "Арена", 900, 1000.0, "Группа", "Рок");
+    system.createConcert("Концерт", "2029-06-01", "Арена", 1000, 1000.0, "Группа", "Рок");
+
+    expectNames(system.suggestEvents("фест", 2, BookingSystem::SuggestionOrder::UPCOMING),
+        { "Фестиваль Г", "Фестиваль В" }, "ближайшие события");
+    expectNames(system.suggestEvents("фест", 2, BookingSystem::SuggestionOrder::AVAILABLE_SEATS),
+        { "Фестиваль Д", "Фестиваль В" }, "события с наибольшим числом мест");
+    // Прошедшее событие идет после всех будущих
+    expectNames(system.suggestEvents("фест", 10, BookingSystem::SuggestionOrder::UPCOMING),
+        { "Фестиваль Г", "Фестиваль В", "Фестиваль Б", "Фестиваль Д", "Фестиваль А" }, "все совпадения");
+    expectNames(system.suggestEvents("фест", 0, BookingSystem::SuggestionOrder::UPCOMING), {}, "нулевой предел");
+
+    std::cout << "Проверено подсказок: 4\n";
+    BookingSystem::destroy();
+}
@@ -0,0 +1,11 @@
+#ifndef TESTS_H
+#define TESTS_H
+
+#include <string>
+
+// Отмечает непройденную проверку; итог по всем тестам подводит main
+void check(bool condition, const std::string& message);
+
+void testConcurrentBooking();
+void testSuggestions();
+#endif